@@ -0,0 +1,295 @@
+/**
+ * @file batch.cpp
+ * @author Utkarsh Sachan
+ * @brief Implementation of batch mode (see batch.hpp).
+ */
+
+#include "batch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <opencv2/opencv.hpp>
+
+#include "bounded_queue.hpp"
+#include "face_detect.hpp"
+#include "image_probe.hpp"
+#include "seam_carver.hpp"
+#include "thread_pool.hpp"
+
+namespace {
+
+const int PIXELS_PER_THREAD = 2 * 1024 * 1024;
+
+// Work items per thread when probing a manifest, to balance slow files.
+const int VALIDATE_CHUNKS_PER_THREAD = 16;
+
+// Default decoder (and encoder) threads: one per this many carving threads.
+const int IO_THREAD_SHARE = 4;
+
+/**
+ * @brief One image travelling through the decode -> carve -> encode pipeline.
+ */
+struct BatchJob {
+    const BatchEntry* entry = nullptr;
+    std::unique_ptr<SeamCarver> carver;
+    int width = 0;
+    int height = 0;
+    std::string error; ///< Set by a failed stage; later stages only report it.
+    std::chrono::steady_clock::time_point start;
+};
+
+std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+int parseDimension(const std::string& field, int line) {
+    if (field.empty()) {
+        return -1;
+    }
+    try {
+        size_t used = 0;
+        int value = std::stoi(field, &used);
+        if (used == field.size() && value >= -1) {
+            return value;
+        }
+    } catch (const std::exception&) {
+    }
+    throw std::runtime_error("Manifest line " + std::to_string(line) + ": invalid dimension '" + field + "'");
+}
+
+} // namespace
+
+std::vector<BatchEntry> readManifest(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Could not open manifest: " + path);
+    }
+
+    std::vector<BatchEntry> entries;
+    std::string text;
+    int lineNumber = 0;
+    while (std::getline(file, text)) {
+        ++lineNumber;
+        text = trim(text.substr(0, text.find('#')));
+        if (text.empty()) {
+            continue;
+        }
+
+        std::vector<std::string> fields;
+        std::stringstream stream(text);
+        std::string field;
+        while (std::getline(stream, field, ',')) {
+            fields.push_back(trim(field));
+        }
+        if (fields.size() < 2 || fields.size() > 6 || fields[0].empty() || fields[1].empty()) {
+            throw std::runtime_error("Manifest line " + std::to_string(lineNumber) +
+                                     ": expected input,output[,width[,height[,protect[,remove]]]]");
+        }
+
+        BatchEntry entry;
+        entry.line = lineNumber;
+        entry.input = fields[0];
+        entry.output = fields[1];
+        if (fields.size() > 2) entry.width = parseDimension(fields[2], lineNumber);
+        if (fields.size() > 3) entry.height = parseDimension(fields[3], lineNumber);
+        if (fields.size() > 4) entry.protectMask = fields[4];
+        if (fields.size() > 5) entry.removeMask = fields[5];
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+int threadsForImage(int width, int height, int poolSize, int otherCarvers) {
+    long long pixels = static_cast<long long>(width) * height;
+    long long available = std::max(1, poolSize - otherCarvers);
+    return static_cast<int>(std::max(1LL, std::min(available, pixels / PIXELS_PER_THREAD)));
+}
+
+int validateManifest(const std::vector<BatchEntry>& entries, int jobs) {
+    // Probing is I/O bound; overlap the header reads of many files.
+    ThreadPool pool(jobs > 0 ? static_cast<unsigned>(jobs) : 0u);
+    std::mutex outputMutex;
+    std::atomic<int> invalid{0};
+
+    auto check = [](const std::string& path, cv::Size& size) -> std::string {
+        if (probeImageSize(path, size)) {
+            return "";
+        }
+        return std::ifstream(path, std::ios::binary) ? "" : "cannot read " + path;
+    };
+
+    pool.parallelFor(static_cast<int>(entries.size()), pool.size() * VALIDATE_CHUNKS_PER_THREAD, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            const BatchEntry& entry = entries[i];
+            cv::Size size;
+            cv::Size unused;
+            std::string problem = check(entry.input, size);
+            if (problem.empty() && !entry.protectMask.empty()) problem = check(entry.protectMask, unused);
+            if (problem.empty() && !entry.removeMask.empty()) problem = check(entry.removeMask, unused);
+            if (problem.empty() && size.area() > 0 && (entry.width > 2 * size.width || entry.height > 2 * size.height)) {
+                problem = "target " + std::to_string(entry.width) + "x" + std::to_string(entry.height) +
+                          " is more than twice the input size " + std::to_string(size.width) + "x" + std::to_string(size.height);
+            }
+            if (!problem.empty()) {
+                invalid.fetch_add(1);
+                std::lock_guard<std::mutex> lock(outputMutex);
+                std::cout << "line " << entry.line << ": " << problem << '\n';
+            }
+        }
+    });
+
+    std::cout << "Validation complete: " << (entries.size() - invalid.load()) << " valid, " << invalid.load() << " invalid" << std::endl;
+    return invalid.load();
+}
+
+int runBatch(const std::vector<BatchEntry>& entries, const BatchOptions& options) {
+    // The pool owns all parallelism; OpenCV's own threads would oversubscribe.
+    cv::setNumThreads(1);
+    ThreadPool pool(options.jobs > 0 ? static_cast<unsigned>(options.jobs) : 0u);
+    const int ioThreads = (options.ioThreads > 0) ? options.ioThreads : std::max(1, pool.size() / IO_THREAD_SHARE);
+
+    std::mutex outputMutex;
+    std::atomic<int> failures{0};
+    std::atomic<int> finished{0};
+    const int total = static_cast<int>(entries.size());
+
+    // One detector for the whole batch: cascades load once per decoder thread,
+    // not per image. Decoders already run in parallel, so each detects alone.
+    std::unique_ptr<FaceDetector> faceDetector;
+    if (options.protectFaces) {
+        FaceDetectionOptions faceOptions = options.faceDetection;
+        faceOptions.threads = 1;
+        faceDetector.reset(new FaceDetector(options.cascadePath, faceOptions));
+    }
+
+    std::cout << "Batch: " << total << " image(s) on " << pool.size() << " thread(s), " << ioThreads
+              << " decoder(s) and encoder(s)" << std::endl;
+
+    // Decode -> carve -> encode. Each queue holds about one image per carving
+    // worker, so decoders stall instead of filling memory when carving is the
+    // bottleneck, and carvers stall when encoding is.
+    BoundedQueue<BatchJob> decoded(pool.size());
+    BoundedQueue<BatchJob> carved(pool.size());
+
+    // --- Decode stage ---
+    std::atomic<size_t> nextEntry{0};
+    std::vector<std::thread> decoders;
+    for (int i = 0; i < ioThreads; ++i) {
+        decoders.emplace_back([&] {
+            for (size_t index = nextEntry.fetch_add(1); index < entries.size(); index = nextEntry.fetch_add(1)) {
+                BatchJob job;
+                job.entry = &entries[index];
+                job.start = std::chrono::steady_clock::now();
+                try {
+                    // Large downscales of JPEGs decode at reduced resolution (see SeamCarver).
+                    cv::Size target(job.entry->width, job.entry->height);
+                    cv::Size original;
+                    if ((target.width == -1 || target.height == -1) && probeImageSize(job.entry->input, original)) {
+                        if (target.width == -1) target.width = original.width;
+                        if (target.height == -1) target.height = original.height;
+                    }
+                    job.carver.reset(new SeamCarver(job.entry->input, job.entry->protectMask, job.entry->removeMask, target));
+                    job.carver->setEnergyFunction(options.energy);
+                    if (faceDetector) {
+                        protectFaces(*job.carver, *faceDetector);
+                    }
+                } catch (const std::exception& e) {
+                    job.error = e.what();
+                }
+                // Failed jobs skip carving and go straight to reporting.
+                (job.error.empty() ? decoded : carved).push(std::move(job));
+            }
+        });
+    }
+
+    // --- Carve stage: one loop per pool worker ---
+    // The loops run on their own threads, not as pool tasks: a loop blocks
+    // for the whole batch, so the workers it occupied could never pick up the
+    // helper chunks that large images split their carving loops into.
+    // Each image takes only the threads the other busy carvers leave, so
+    // carvers and their helpers together stay within the pool size.
+    std::vector<std::thread> carvers;
+    std::atomic<int> busyCarvers{0};
+    for (int i = 0; i < pool.size(); ++i) {
+        carvers.emplace_back([&] {
+            BatchJob job;
+            while (decoded.pop(job)) {
+                const int others = busyCarvers.fetch_add(1);
+                try {
+                    const cv::Mat& image = job.carver->image();
+                    job.width = (job.entry->width == -1) ? image.cols : job.entry->width;
+                    job.height = (job.entry->height == -1) ? image.rows : job.entry->height;
+                    job.carver->setThreadPool(&pool, threadsForImage(image.cols, image.rows, pool.size(), others));
+                    job.carver->resize(job.width, job.height);
+                } catch (const std::exception& e) {
+                    job.error = e.what();
+                }
+                busyCarvers.fetch_sub(1);
+                carved.push(std::move(job));
+            }
+        });
+    }
+
+    // --- Encode stage ---
+    std::vector<std::thread> encoders;
+    for (int i = 0; i < ioThreads; ++i) {
+        encoders.emplace_back([&] {
+            BatchJob job;
+            while (carved.pop(job)) {
+                std::string status;
+                std::string stats;
+                try {
+                    if (!job.error.empty()) {
+                        throw std::runtime_error(job.error);
+                    }
+                    job.carver->saveImage(job.entry->output);
+                    if (options.stats) {
+                        stats = job.carver->stats().toJson();
+                    }
+                    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - job.start);
+                    status = "ok (" + std::to_string(job.width) + "x" + std::to_string(job.height) + ", " +
+                             std::to_string(elapsed.count()) + " ms)";
+                } catch (const std::exception& e) {
+                    failures.fetch_add(1);
+                    status = std::string("FAILED: ") + e.what();
+                }
+                job.carver.reset(); // release the image before waiting for the next one
+
+                std::lock_guard<std::mutex> lock(outputMutex);
+                std::cout << "[" << ++finished << "/" << total << "] line " << job.entry->line << ": "
+                          << job.entry->input << " -> " << job.entry->output << " " << status << '\n';
+                if (!stats.empty()) {
+                    std::cout << stats << '\n';
+                }
+            }
+        });
+    }
+
+    for (std::thread& decoder : decoders) {
+        decoder.join();
+    }
+    decoded.close();
+    for (std::thread& carver : carvers) {
+        carver.join();
+    }
+    carved.close();
+    for (std::thread& encoder : encoders) {
+        encoder.join();
+    }
+
+    std::cout << "Batch complete: " << (total - failures.load()) << " succeeded, " << failures.load() << " failed" << std::endl;
+    return failures.load();
+}
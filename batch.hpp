@@ -0,0 +1,84 @@
+/**
+ * @file batch.hpp
+ * @author Utkarsh Sachan
+ * @brief Batch mode: carve many images in one process on a shared thread pool.
+ *
+ * Manifest format (CSV, one job per line, `#` starts a comment):
+ *
+ *   input,output[,width[,height[,protect_mask[,remove_mask]]]]
+ *
+ * Empty or -1 width/height keep the original dimension. Example:
+ *
+ *   # input            output              w    h    protect
+ *   photos/a.jpg,      out/a.jpg,          800, 600
+ *   photos/b.png,      out/b.png,          ,    400, masks/b_faces.png
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "energy.hpp"
+#include "face_detect.hpp"
+
+/**
+ * @brief One manifest line.
+ */
+struct BatchEntry {
+    std::string input;
+    std::string output;
+    int width = -1;
+    int height = -1;
+    std::string protectMask;
+    std::string removeMask;
+    int line = 0; ///< 1-based manifest line, for error messages.
+};
+
+/**
+ * @brief Settings shared by every job of a batch.
+ */
+struct BatchOptions {
+    int jobs = 0; ///< Worker threads (0 = hardware concurrency).
+    int ioThreads = 0; ///< Decoder threads, and as many encoder threads (0 = one per 4 workers).
+    EnergyFunction energy = EnergyFunction::Sobel5;
+    bool stats = false; ///< Print each job's ResizeStats JSON after its result line.
+    bool protectFaces = false; ///< Detect faces in each input and protect them (see face_detect.hpp).
+    std::string cascadePath;   ///< Haar cascade for protectFaces (empty = search the OpenCV install).
+    FaceDetectionOptions faceDetection; ///< Detection settings for protectFaces (threads are ignored).
+};
+
+/**
+ * @brief Parses a batch manifest.
+ * @throws std::runtime_error if the file cannot be read or a line is malformed.
+ */
+std::vector<BatchEntry> readManifest(const std::string& path);
+
+/**
+ * @brief Checks every entry from file headers alone, without decoding pixels.
+ *
+ * Inputs and masks must exist and have a recognized header (JPEG, PNG, WebP
+ * or TIFF; other formats are only checked for existence), and targets must
+ * be at most twice the input size, the most one insertion pass can add.
+ * Prints one line per problem.
+ * @return The number of invalid entries.
+ */
+int validateManifest(const std::vector<BatchEntry>& entries, int jobs = 0);
+
+/**
+ * @brief Processes all entries concurrently, one carving thread per pool worker.
+ *
+ * Decoding, carving and encoding are pipelined: dedicated I/O threads decode
+ * upcoming images and encode finished ones while the carving threads work,
+ * connected by bounded queues for backpressure. Large images additionally
+ * split their carving loops across the work-stealing pool (see threadsForImage()).
+ * @return The number of entries that failed.
+ */
+int runBatch(const std::vector<BatchEntry>& entries, const BatchOptions& options);
+
+/**
+ * @brief Threads to give one image: one per ~2 megapixels, capped by the pool
+ * size less the threads already carving other images (at least one).
+ * @param otherCarvers Images being carved concurrently, each on its own thread.
+ */
+int threadsForImage(int width, int height, int poolSize, int otherCarvers = 0);
@@ -0,0 +1,408 @@
+/**
+ * @file benchmark.cpp
+ * @author Utkarsh Sachan
+ * @brief Benchmarks for the carving hot paths of libseamcarver.
+ *
+ * Runs energy computation, seam removal (vertical and horizontal search),
+ * seam insertion and end-to-end resizes on deterministic synthetic images,
+ * across image sizes, mask densities and seam counts. Per-phase times come
+ * from `SeamCarver::stats()`, so the numbers match what `--stats` reports in
+ * production. Each case is repeated and the median is reported.
+ *
+ * Build:
+ * g++ -std=c++17 -O2 -o benchmark benchmark.cpp seam_carver_lib.cpp vector_mask.cpp -pthread `pkg-config --cflags --libs opencv4`
+ *
+ * Usage:
+ * ./benchmark                                       # quick suite, console table
+ * ./benchmark --sizes=vga,1080p,50mp --seams=1,100  # pick the grid
+ * ./benchmark --format=json --out=bench.json        # Google Benchmark-style JSON
+ * ./benchmark --filter=carve_width --threads=8      # subset, multi-threaded carver
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "seam_carver.hpp"
+#include "thread_pool.hpp"
+
+namespace {
+
+struct ImageSize {
+    const char* name;
+    int width;
+    int height;
+};
+
+const ImageSize IMAGE_SIZES[] = {
+    {"vga", 640, 480},
+    {"720p", 1280, 720},
+    {"1080p", 1920, 1080},
+    {"4k", 3840, 2160},
+    {"12mp", 4000, 3000},
+    {"50mp", 8660, 5773},
+};
+
+const EnergyFunction ALL_ENERGY_FUNCTIONS[] = {
+    EnergyFunction::Sobel3, EnergyFunction::Sobel5, EnergyFunction::Scharr, EnergyFunction::DualGradient,
+    EnergyFunction::RGBGradient, EnergyFunction::Entropy, EnergyFunction::Saliency,
+};
+
+/**
+ * @brief Result of one benchmark case (median over repetitions, in ms).
+ */
+struct BenchmarkResult {
+    std::string name;
+    int width = 0;
+    int height = 0;
+    int seams = 0;
+    double maskDensity = 0.0;
+    int repetitions = 0;
+    double medianMs = 0.0;
+    double minMs = 0.0;
+    ResizeStats stats; ///< Per-phase stats of the median run (resize cases only).
+    bool hasStats = false;
+};
+
+std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+const ImageSize& findSize(const std::string& name) {
+    for (const ImageSize& size : IMAGE_SIZES) {
+        if (name == size.name) return size;
+    }
+    throw std::invalid_argument("Unknown size '" + name + "' (use vga, 720p, 1080p, 4k, 12mp, 50mp)");
+}
+
+const char* energyName(EnergyFunction energy) {
+    switch (energy) {
+        case EnergyFunction::Sobel3: return Sobel3Energy::name();
+        case EnergyFunction::Sobel5: return Sobel5Energy::name();
+        case EnergyFunction::Scharr: return ScharrEnergy::name();
+        case EnergyFunction::DualGradient: return DualGradientEnergy::name();
+        case EnergyFunction::RGBGradient: return RGBGradientEnergy::name();
+        case EnergyFunction::Entropy: return EntropyEnergy::name();
+        case EnergyFunction::Saliency: return SaliencyEnergy::name();
+    }
+    return "unknown";
+}
+
+void computeEnergy(EnergyFunction energy, const cv::Mat& image, cv::Mat& out) {
+    switch (energy) {
+        case EnergyFunction::Sobel3: Sobel3Energy::compute(image, out); break;
+        case EnergyFunction::Sobel5: Sobel5Energy::compute(image, out); break;
+        case EnergyFunction::Scharr: ScharrEnergy::compute(image, out); break;
+        case EnergyFunction::DualGradient: DualGradientEnergy::compute(image, out); break;
+        case EnergyFunction::RGBGradient: RGBGradientEnergy::compute(image, out); break;
+        case EnergyFunction::Entropy: EntropyEnergy::compute(image, out); break;
+        case EnergyFunction::Saliency: SaliencyEnergy::compute(image, out); break;
+    }
+}
+
+/**
+ * @brief A deterministic photo-like test image: smooth gradient background,
+ * flat-colored blocks (strong edges) and mild sensor-like noise.
+ */
+cv::Mat syntheticImage(int width, int height) {
+    std::mt19937 rng(12345);
+    cv::Mat image(height, width, CV_8UC3);
+    for (int r = 0; r < height; ++r) {
+        cv::Vec3b* row = image.ptr<cv::Vec3b>(r);
+        for (int c = 0; c < width; ++c) {
+            row[c] = cv::Vec3b(static_cast<uchar>(255 * c / width), static_cast<uchar>(255 * r / height), 128);
+        }
+    }
+
+    std::uniform_int_distribution<int> color(0, 255);
+    std::uniform_int_distribution<int> x(0, width - 1);
+    std::uniform_int_distribution<int> y(0, height - 1);
+    for (int i = 0; i < 40; ++i) {
+        cv::Point a(x(rng), y(rng));
+        cv::Point b(std::min(width - 1, a.x + x(rng) / 4), std::min(height - 1, a.y + y(rng) / 4));
+        cv::rectangle(image, a, b, cv::Scalar(color(rng), color(rng), color(rng)), -1);
+    }
+
+    std::uniform_int_distribution<int> noise(-6, 6);
+    for (int r = 0; r < height; ++r) {
+        uchar* row = image.ptr<uchar>(r);
+        for (int c = 0; c < width * 3; ++c) {
+            row[c] = cv::saturate_cast<uchar>(row[c] + noise(rng));
+        }
+    }
+    return image;
+}
+
+/**
+ * @brief A protection mask covering `density` of the image with one centered
+ * block, like a detected subject.
+ */
+cv::Mat syntheticMask(int width, int height, double density) {
+    if (density <= 0.0) {
+        return cv::Mat();
+    }
+    cv::Mat mask = cv::Mat::zeros(height, width, CV_8UC1);
+    double scale = std::sqrt(std::min(density, 1.0));
+    int w = static_cast<int>(width * scale);
+    int h = static_cast<int>(height * scale);
+    cv::rectangle(mask, cv::Rect((width - w) / 2, (height - h) / 2, w, h), cv::Scalar(255), -1);
+    return mask;
+}
+
+/**
+ * @brief Runs `fn` `repetitions` times and fills in median and minimum times.
+ * @param fn Runs one repetition and returns its wall time in ms.
+ * @param statsOf Optional: the stats of the repetition just run.
+ */
+void measure(BenchmarkResult& result, int repetitions, const std::function<double()>& fn,
+             const std::function<const ResizeStats*()>& statsOf = nullptr) {
+    std::vector<std::pair<double, ResizeStats>> runs;
+    for (int i = 0; i < repetitions; ++i) {
+        double ms = fn();
+        const ResizeStats* stats = statsOf ? statsOf() : nullptr;
+        runs.emplace_back(ms, stats ? *stats : ResizeStats());
+    }
+    std::sort(runs.begin(), runs.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    result.repetitions = repetitions;
+    result.minMs = runs.front().first;
+    result.medianMs = runs[runs.size() / 2].first;
+    result.stats = runs[runs.size() / 2].second;
+    result.hasStats = static_cast<bool>(statsOf);
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// ---
+// Output
+// ---
+
+void writeConsole(std::ostream& out, const std::vector<BenchmarkResult>& results) {
+    out << std::left << std::setw(52) << "benchmark" << std::right << std::setw(12) << "median ms" << std::setw(12) << "min ms"
+        << std::setw(11) << "energy" << std::setw(11) << "search" << std::setw(11) << "removal" << std::setw(11) << "insert"
+        << std::setw(14) << "ns/px/seam" << "\n";
+    out << std::fixed << std::setprecision(2);
+    for (const BenchmarkResult& r : results) {
+        out << std::left << std::setw(52) << r.name << std::right << std::setw(12) << r.medianMs << std::setw(12) << r.minMs;
+        if (r.hasStats) {
+            out << std::setw(11) << r.stats.energy.milliseconds
+                << std::setw(11) << (r.stats.verticalSearch.milliseconds + r.stats.horizontalSearch.milliseconds)
+                << std::setw(11) << r.stats.removal.milliseconds << std::setw(11) << r.stats.insertion.milliseconds;
+        } else {
+            out << std::setw(11) << "-" << std::setw(11) << "-" << std::setw(11) << "-" << std::setw(11) << "-";
+        }
+        double work = static_cast<double>(r.width) * r.height * std::max(1, r.seams);
+        out << std::setw(14) << (r.medianMs * 1e6 / work) << "\n";
+    }
+}
+
+void writeCsv(std::ostream& out, const std::vector<BenchmarkResult>& results) {
+    out << "name,width,height,seams,mask_density,repetitions,median_ms,min_ms,"
+           "energy_ms,vertical_search_ms,horizontal_search_ms,removal_ms,insertion_ms,bytes_allocated\n";
+    for (const BenchmarkResult& r : results) {
+        const ResizeStats& s = r.stats;
+        long long bytes = s.energy.bytesAllocated + s.verticalSearch.bytesAllocated + s.horizontalSearch.bytesAllocated +
+                          s.removal.bytesAllocated + s.insertion.bytesAllocated;
+        out << r.name << "," << r.width << "," << r.height << "," << r.seams << "," << r.maskDensity << ","
+            << r.repetitions << "," << r.medianMs << "," << r.minMs << "," << s.energy.milliseconds << ","
+            << s.verticalSearch.milliseconds << "," << s.horizontalSearch.milliseconds << ","
+            << s.removal.milliseconds << "," << s.insertion.milliseconds << "," << bytes << "\n";
+    }
+}
+
+/**
+ * @brief Writes results in the Google Benchmark JSON layout, so existing
+ * tracking tools (e.g. compare.py) can consume them. Resize cases embed the
+ * full ResizeStats under "stats".
+ */
+void writeJson(std::ostream& out, const std::vector<BenchmarkResult>& results, int threads) {
+    char date[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    out << std::fixed << std::setprecision(3);
+    out << "{\n  \"context\": {\"date\": \"" << date << "\", \"executable\": \"benchmark\", \"num_cpus\": "
+        << std::thread::hardware_concurrency() << ", \"carver_threads\": " << threads << "},\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult& r = results[i];
+        out << (i ? ",\n" : "\n") << "    {\"name\": \"" << r.name << "\", \"run_type\": \"aggregate\", \"aggregate_name\": \"median\""
+            << ", \"repetitions\": " << r.repetitions << ", \"real_time\": " << r.medianMs << ", \"min_time\": " << r.minMs
+            << ", \"time_unit\": \"ms\", \"width\": " << r.width << ", \"height\": " << r.height << ", \"seams\": " << r.seams
+            << ", \"mask_density\": " << r.maskDensity;
+        if (r.hasStats) {
+            out << ", \"stats\": " << r.stats.toJson();
+        }
+        out << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+} // namespace
+
+const char* keys =
+    "{help usage ?   |                | print this message }"
+    "{ sizes         | vga,720p,1080p | image sizes: vga, 720p, 1080p, 4k, 12mp, 50mp }"
+    "{ seams         | 10,100         | seam counts for the carving cases }"
+    "{ masks         | 0,0.1          | protection mask densities (fraction of the image) }"
+    "{ energy        | sobel5         | energy functions for the carving cases, or 'all' }"
+    "{ repetitions   | 3              | runs per case (the median is reported) }"
+    "{ threads       | 1              | carver threads (1 = single-threaded, 0 = all cores) }"
+    "{ filter        |                | only run cases whose name contains this text }"
+    "{ format        | console        | output format: console, csv, json }"
+    "{ out           |                | write results to this file instead of stdout }";
+
+int main(int argc, char* argv[]) {
+    cv::CommandLineParser parser(argc, argv, keys);
+    parser.about("Seam Carving Benchmarks");
+    if (parser.has("help")) {
+        parser.printMessage();
+        return 0;
+    }
+
+    try {
+        std::vector<const ImageSize*> sizes;
+        for (const std::string& name : splitList(parser.get<std::string>("sizes"))) {
+            sizes.push_back(&findSize(name));
+        }
+        std::vector<int> seamCounts;
+        for (const std::string& count : splitList(parser.get<std::string>("seams"))) {
+            seamCounts.push_back(std::stoi(count));
+        }
+        std::vector<double> densities;
+        for (const std::string& density : splitList(parser.get<std::string>("masks"))) {
+            densities.push_back(std::stod(density));
+        }
+        std::vector<EnergyFunction> energies;
+        std::string energyList = parser.get<std::string>("energy");
+        if (energyList == "all") {
+            energies.assign(std::begin(ALL_ENERGY_FUNCTIONS), std::end(ALL_ENERGY_FUNCTIONS));
+        } else {
+            for (const std::string& name : splitList(energyList)) {
+                energies.push_back(parseEnergyFunction(name));
+            }
+        }
+        int repetitions = std::max(1, parser.get<int>("repetitions"));
+        int threads = parser.get<int>("threads");
+        std::string filter = parser.get<std::string>("filter");
+        std::string format = parser.get<std::string>("format");
+        if (format != "console" && format != "csv" && format != "json") {
+            throw std::invalid_argument("Unknown format '" + format + "' (use console, csv, json)");
+        }
+
+        std::unique_ptr<ThreadPool> pool;
+        if (threads != 1) {
+            // The calling thread also works, so the pool needs one thread fewer.
+            unsigned helpers = threads > 1 ? static_cast<unsigned>(threads - 1) : 0u;
+            pool.reset(new ThreadPool(helpers));
+            threads = pool->size() + 1;
+        }
+
+        std::vector<BenchmarkResult> results;
+        auto selected = [&](const std::string& name) { return filter.empty() || name.find(filter) != std::string::npos; };
+
+        for (const ImageSize* size : sizes) {
+            cv::Mat image = syntheticImage(size->width, size->height);
+
+            // --- Energy computation alone, for every requested policy ---
+            for (EnergyFunction energy : energies) {
+                BenchmarkResult result;
+                result.name = std::string("energy/") + energyName(energy) + "/" + size->name;
+                if (!selected(result.name)) continue;
+                result.width = size->width;
+                result.height = size->height;
+                cv::Mat out;
+                measure(result, repetitions, [&] {
+                    auto start = std::chrono::steady_clock::now();
+                    computeEnergy(energy, image, out);
+                    return elapsedMs(start);
+                });
+                std::cerr << result.name << ": " << result.medianMs << " ms" << std::endl;
+                results.push_back(result);
+            }
+
+            // --- Carving: removal (both directions), insertion and end-to-end ---
+            struct Scenario {
+                const char* name;
+                int dWidth;
+                int dHeight;
+            };
+            const Scenario scenarios[] = {
+                {"carve_width", -1, 0},  // energy + vertical search + removal
+                {"carve_height", 0, -1}, // energy + horizontal search + removal
+                {"expand_width", 1, 0},  // insertion search + insertion
+                {"resize", -1, -1},      // end-to-end, both dimensions
+            };
+
+            for (EnergyFunction energy : energies) {
+                for (double density : densities) {
+                    cv::Mat mask = syntheticMask(size->width, size->height, density);
+                    for (int seams : seamCounts) {
+                        for (const Scenario& scenario : scenarios) {
+                            std::ostringstream name;
+                            name << scenario.name << "/" << energyName(energy) << "/" << size->name
+                                 << "/seams:" << seams << "/mask:" << density;
+                            BenchmarkResult result;
+                            result.name = name.str();
+                            if (!selected(result.name)) continue;
+                            if (seams >= std::min(size->width, size->height)) continue;
+                            result.width = size->width;
+                            result.height = size->height;
+                            result.seams = seams;
+                            result.maskDensity = density;
+
+                            std::unique_ptr<SeamCarver> carver;
+                            measure(result, repetitions, [&] {
+                                carver.reset(new SeamCarver(image, mask));
+                                carver->setEnergyFunction(energy);
+                                if (pool) carver->setThreadPool(pool.get(), threads);
+                                auto start = std::chrono::steady_clock::now();
+                                carver->resize(size->width + scenario.dWidth * seams, size->height + scenario.dHeight * seams);
+                                return elapsedMs(start);
+                            }, [&] { return &carver->stats(); });
+                            std::cerr << result.name << ": " << result.medianMs << " ms" << std::endl;
+                            results.push_back(result);
+                        }
+                    }
+                }
+            }
+        }
+
+        std::ofstream file;
+        std::string outPath = parser.get<std::string>("out");
+        if (!outPath.empty()) {
+            file.open(outPath);
+            if (!file) throw std::runtime_error("Could not open output file: " + outPath);
+        }
+        std::ostream& out = outPath.empty() ? std::cout : file;
+        if (format == "json") {
+            writeJson(out, results, threads);
+        } else if (format == "csv") {
+            writeCsv(out, results);
+        } else {
+            writeConsole(out, results);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "An error occurred: " << e.what() << std::endl;
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file bounded_queue.hpp
+ * @author Utkarsh Sachan
+ * @brief A blocking, bounded FIFO for connecting pipeline stages.
+ *
+ * A full queue blocks the producer (backpressure), so a fast stage cannot run
+ * ahead of a slow one and pile up decoded images. Closing the queue wakes
+ * everyone: consumers drain what is left, producers stop.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : m_capacity(capacity > 0 ? capacity : 1) {}
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /**
+     * @brief Appends an item, waiting while the queue is full.
+     * @return false if the queue was closed (the item is dropped).
+     */
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notFull.wait(lock, [this] { return m_closed || m_items.size() < m_capacity; });
+        if (m_closed) {
+            return false;
+        }
+        m_items.push_back(std::move(item));
+        lock.unlock();
+        m_notEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Removes the oldest item, waiting while the queue is empty.
+     * @return false once the queue is closed and drained.
+     */
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notEmpty.wait(lock, [this] { return m_closed || !m_items.empty(); });
+        if (m_items.empty()) {
+            return false;
+        }
+        item = std::move(m_items.front());
+        m_items.pop_front();
+        lock.unlock();
+        m_notFull.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Ends the stream: pending items can still be popped, pushes fail.
+     */
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+        }
+        m_notEmpty.notify_all();
+        m_notFull.notify_all();
+    }
+
+private:
+    const size_t m_capacity;
+    std::deque<T> m_items;
+    std::mutex m_mutex;
+    std::condition_variable m_notEmpty;
+    std::condition_variable m_notFull;
+    bool m_closed = false;
+};
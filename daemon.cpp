@@ -0,0 +1,643 @@
+/**
+ * @file daemon.cpp
+ * @author Utkarsh Sachan
+ * @brief Implementation of the resident resize daemon and its client (see daemon.hpp).
+ */
+
+#include "daemon.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <opencv2/opencv.hpp>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "batch.hpp"
+#include "logging.hpp"
+#include "seam_carver.hpp"
+#include "thread_pool.hpp"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0 // SIGPIPE is ignored by the daemon instead (macOS)
+#endif
+
+namespace {
+
+const int MAX_PASSED_FDS = 4; // input, output, protect, remove
+
+std::atomic<bool> g_stopRequested{false};
+
+void onStopSignal(int) {
+    g_stopRequested = true;
+}
+
+/**
+ * @brief Reads exactly `size` bytes.
+ * @return false on a clean EOF before the first byte.
+ * @throws std::runtime_error on errors or EOF mid-message.
+ */
+bool readFully(int fd, void* data, size_t size) {
+    char* out = static_cast<char*>(data);
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = ::recv(fd, out + done, size - done, 0);
+        if (n == 0) {
+            if (done == 0) return false;
+            throw std::runtime_error("Connection closed mid-message");
+        }
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("recv failed: ") + std::strerror(errno));
+        }
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+/**
+ * @brief Writes exactly `size` bytes (never raises SIGPIPE).
+ * @throws std::runtime_error on errors.
+ */
+void writeFully(int fd, const void* data, size_t size) {
+    const char* in = static_cast<const char*>(data);
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = ::send(fd, in + done, size - done, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("send failed: ") + std::strerror(errno));
+        }
+        done += static_cast<size_t>(n);
+    }
+}
+
+/**
+ * @brief Reads a request header and any file descriptors attached to it.
+ * @return false on a clean EOF before the header.
+ */
+bool readHeaderWithFds(int fd, DaemonRequestHeader& header, std::vector<int>& fds) {
+    char control[CMSG_SPACE(sizeof(int) * MAX_PASSED_FDS)];
+    iovec io = {&header, sizeof(header)};
+    msghdr message;
+    std::memset(&message, 0, sizeof(message));
+    message.msg_iov = &io;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+
+    ssize_t n;
+    do {
+        n = ::recvmsg(fd, &message, 0);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+        throw std::runtime_error(std::string("recvmsg failed: ") + std::strerror(errno));
+    }
+
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg != nullptr; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            const unsigned char* data = CMSG_DATA(cmsg);
+            for (size_t i = 0; i < count; ++i) {
+                int received;
+                std::memcpy(&received, data + i * sizeof(int), sizeof(int));
+                fds.push_back(received);
+            }
+        }
+    }
+    if (message.msg_flags & MSG_CTRUNC) {
+        throw std::runtime_error("Too many file descriptors attached to request");
+    }
+
+    if (n == 0) {
+        return false;
+    }
+    if (static_cast<size_t>(n) < sizeof(header) &&
+        !readFully(fd, reinterpret_cast<char*>(&header) + n, sizeof(header) - n)) {
+        throw std::runtime_error("Connection closed mid-message");
+    }
+    return true;
+}
+
+/**
+ * @brief Writes a request header with file descriptors attached.
+ */
+void writeHeaderWithFds(int fd, const DaemonRequestHeader& header, const std::vector<int>& fds) {
+    char control[CMSG_SPACE(sizeof(int) * MAX_PASSED_FDS)];
+    std::memset(control, 0, sizeof(control));
+    iovec io = {const_cast<DaemonRequestHeader*>(&header), sizeof(header)};
+    msghdr message;
+    std::memset(&message, 0, sizeof(message));
+    message.msg_iov = &io;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = CMSG_SPACE(sizeof(int) * fds.size());
+
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fds.size());
+    std::memcpy(CMSG_DATA(cmsg), fds.data(), sizeof(int) * fds.size());
+
+    ssize_t n;
+    do {
+        n = ::sendmsg(fd, &message, MSG_NOSIGNAL);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+        throw std::runtime_error(std::string("sendmsg failed: ") + std::strerror(errno));
+    }
+    // Descriptors travel with the first byte; the rest of the header is plain data.
+    writeFully(fd, reinterpret_cast<const char*>(&header) + n, sizeof(header) - n);
+}
+
+/**
+ * @brief Closes received file descriptors when a request is done.
+ */
+struct ReceivedFds {
+    std::vector<int> fds;
+    ~ReceivedFds() {
+        for (int fd : fds) ::close(fd);
+    }
+};
+
+/**
+ * @brief Maps a received shared-memory segment for the duration of a request.
+ */
+class MappedSegment {
+public:
+    MappedSegment(int fd, size_t bytes, bool writable) : m_size(bytes) {
+        struct stat info;
+        if (::fstat(fd, &info) < 0 || static_cast<uint64_t>(info.st_size) < bytes) {
+            throw std::invalid_argument("Shared-memory segment is smaller than declared");
+        }
+        m_data = ::mmap(nullptr, bytes, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+        if (m_data == MAP_FAILED) {
+            m_data = nullptr;
+            throw std::runtime_error(std::string("mmap failed: ") + std::strerror(errno));
+        }
+    }
+    ~MappedSegment() {
+        if (m_data) ::munmap(m_data, m_size);
+    }
+    MappedSegment(const MappedSegment&) = delete;
+    MappedSegment& operator=(const MappedSegment&) = delete;
+
+    void* data() const { return m_data; }
+
+private:
+    void* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+void readPayload(int fd, std::vector<unsigned char>& buffer, uint64_t size) {
+    buffer.resize(size);
+    if (size > 0 && !readFully(fd, buffer.data(), size)) {
+        throw std::runtime_error("Connection closed mid-message");
+    }
+}
+
+sockaddr_un socketAddress(const std::string& path) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Socket path too long: " + path);
+    }
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    return address;
+}
+
+/**
+ * @brief Wraps (raw) or decodes (encoded) an image or mask payload.
+ * Raw payloads are wrapped without copying.
+ */
+cv::Mat payloadToMat(std::vector<unsigned char>& bytes, const DaemonRequestHeader& request, bool mask) {
+    if (bytes.empty()) {
+        return cv::Mat();
+    }
+    if (request.pixelFormat == DAEMON_ENCODED) {
+        cv::Mat decoded = cv::imdecode(bytes, mask ? cv::IMREAD_GRAYSCALE : cv::IMREAD_UNCHANGED);
+        if (decoded.empty()) {
+            throw std::runtime_error(mask ? "Could not decode mask payload" : "Could not decode image payload");
+        }
+        return decoded;
+    }
+
+    // Check the client's dimensions before OpenCV sees them.
+    int type = mask ? CV_8UC1 : cvTypeFor(static_cast<PixelFormat>(request.pixelFormat));
+    if (request.width <= 0 || request.height <= 0 ||
+        bytes.size() / CV_ELEM_SIZE(type) / static_cast<size_t>(request.width) != static_cast<size_t>(request.height) ||
+        bytes.size() % (static_cast<size_t>(request.width) * CV_ELEM_SIZE(type)) != 0) {
+        throw std::invalid_argument("Raw payload size does not match width x height x pixel size");
+    }
+    return cv::Mat(request.height, request.width, type, bytes.data());
+}
+
+/**
+ * @brief Per-connection state. Payload buffers are reused across requests.
+ */
+struct Connection {
+    int fd = -1;
+    std::thread thread;
+    std::atomic<bool> finished{false};
+    std::vector<unsigned char> image;
+    std::vector<unsigned char> protect;
+    std::vector<unsigned char> remove;
+    std::vector<unsigned char> output;
+};
+
+/**
+ * @brief Thrown when a carve was cancelled (timeout or client gone).
+ */
+struct RequestCancelled : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * @brief True if the client has closed its end of the connection.
+ * Pipelined requests waiting in the socket do not count as closed.
+ */
+bool peerClosed(int fd) {
+    char byte;
+    return ::recv(fd, &byte, 1, MSG_PEEK | MSG_DONTWAIT) == 0;
+}
+
+/**
+ * @brief Runs the carve, honoring the request timeout and abandoning it as
+ * soon as the client disconnects.
+ */
+void carve(SeamCarver& carver, const DaemonRequestHeader& request, const DaemonResponseHeader& response, int client) {
+    CancellationToken token;
+    if (request.timeoutMilliseconds > 0) {
+        token.cancelAfter(std::chrono::milliseconds(request.timeoutMilliseconds));
+    }
+    carver.setCancellationToken(token);
+    carver.setProgressCallback([&token, client](int, int) {
+        if (peerClosed(client)) token.cancel();
+    });
+    if (carver.resize(response.width, response.height) == ResizeStatus::Cancelled) {
+        throw RequestCancelled("Resize cancelled after " + std::to_string(carver.stats().totalMilliseconds) + " ms");
+    }
+}
+
+/**
+ * @brief Rejects energy and pixel-format values outside the known enums.
+ */
+void validateRequest(const DaemonRequestHeader& request) {
+    if (request.energy < 0 || request.energy > static_cast<int32_t>(EnergyFunction::Saliency)) {
+        throw std::invalid_argument("Unknown energy function");
+    }
+    if (request.pixelFormat != DAEMON_ENCODED &&
+        (request.pixelFormat < 0 || request.pixelFormat > static_cast<int32_t>(PixelFormat::BGRA16))) {
+        throw std::invalid_argument("Unknown pixel format");
+    }
+}
+
+/**
+ * @brief Applies the request's energy function and a share of the pool, and
+ * fills in the target size of the response.
+ * @throws std::invalid_argument if the target exceeds the daemon's limits,
+ * before anything is allocated for it.
+ */
+DaemonResponseHeader prepareCarver(SeamCarver& carver, const DaemonRequestHeader& request, const cv::Mat& image, ThreadPool& pool,
+                                   const DaemonOptions& options) {
+    DaemonResponseHeader response;
+    response.width = (request.targetWidth == -1) ? image.cols : request.targetWidth;
+    response.height = (request.targetHeight == -1) ? image.rows : request.targetHeight;
+    response.pixelFormat = request.pixelFormat;
+    if (static_cast<long long>(response.width) > static_cast<long long>(image.cols) * options.maxEnlargement ||
+        static_cast<long long>(response.height) > static_cast<long long>(image.rows) * options.maxEnlargement ||
+        static_cast<uint64_t>(response.width) * static_cast<uint64_t>(response.height) > options.maxOutputPixels) {
+        throw std::invalid_argument("Target size " + std::to_string(response.width) + "x" + std::to_string(response.height) +
+                                    " exceeds the daemon limit");
+    }
+
+    carver.setEnergyFunction(static_cast<EnergyFunction>(request.energy));
+    carver.setThreadPool(&pool, threadsForImage(image.cols, image.rows, pool.size()));
+    return response;
+}
+
+/**
+ * @brief Carves one request into `connection.output`.
+ * @return The response header (status and dimensions).
+ */
+DaemonResponseHeader processRequest(const DaemonRequestHeader& request, Connection& connection, ThreadPool& pool,
+                                    const DaemonOptions& options) {
+    const int client = connection.fd;
+    validateRequest(request);
+
+    cv::Mat image = payloadToMat(connection.image, request, false);
+    if (image.empty()) {
+        throw std::invalid_argument("Empty image payload");
+    }
+    SeamCarver carver(image, payloadToMat(connection.protect, request, true), payloadToMat(connection.remove, request, true));
+    DaemonResponseHeader response = prepareCarver(carver, request, image, pool, options);
+
+    if (request.pixelFormat == DAEMON_ENCODED) {
+        carve(carver, request, response, client);
+        std::string extension(request.outputExtension, strnlen(request.outputExtension, sizeof(request.outputExtension)));
+        if (!cv::imencode(extension, carver.image(), connection.output)) {
+            throw std::runtime_error("Could not encode result as " + extension);
+        }
+    } else {
+        // Raw mode: the final carving step writes straight into the response buffer.
+        connection.output.resize(static_cast<size_t>(response.width) * response.height * image.elemSize());
+        carver.setOutputBuffer(connection.output.data(), response.width, response.height, 0);
+        carve(carver, request, response, client);
+    }
+    response.imageBytes = connection.output.size();
+    return response;
+}
+
+/**
+ * @brief Carves a shared-memory request in place: the input segment is read
+ * directly and the final step is written into the output segment.
+ * @param fds Input, output, then protect/remove segments (if declared).
+ */
+DaemonResponseHeader processSharedRequest(const DaemonRequestHeader& request, const std::vector<int>& fds, ThreadPool& pool, int client,
+                                          const DaemonOptions& options) {
+    validateRequest(request);
+    if (request.pixelFormat == DAEMON_ENCODED) {
+        throw std::invalid_argument("Shared memory requires a raw pixel format");
+    }
+    size_t expectedFds = 2 + (request.protectBytes > 0) + (request.removeBytes > 0);
+    if (fds.size() != expectedFds) {
+        throw std::invalid_argument("Shared-memory request carries the wrong number of file descriptors");
+    }
+    if (request.width <= 0 || request.height <= 0) {
+        throw std::invalid_argument("Shared-memory request needs width and height");
+    }
+
+    PixelFormat format = static_cast<PixelFormat>(request.pixelFormat);
+    size_t pixels = static_cast<size_t>(request.width) * request.height;
+    size_t pixelBytes = CV_ELEM_SIZE(cvTypeFor(format));
+    if (request.imageBytes != pixels * pixelBytes ||
+        (request.protectBytes > 0 && request.protectBytes != pixels) ||
+        (request.removeBytes > 0 && request.removeBytes != pixels)) {
+        throw std::invalid_argument("Shared-memory segment sizes do not match width x height x pixel size");
+    }
+
+    size_t next = 0;
+    MappedSegment input(fds[next++], request.imageBytes, false);
+    MappedSegment output(fds[next++], request.outputBytes, true);
+    std::unique_ptr<MappedSegment> protect, remove;
+    if (request.protectBytes > 0) protect.reset(new MappedSegment(fds[next++], request.protectBytes, false));
+    if (request.removeBytes > 0) remove.reset(new MappedSegment(fds[next++], request.removeBytes, false));
+
+    SeamCarver carver = SeamCarver::fromBuffer(input.data(), request.width, request.height, 0, format);
+    if (protect) carver.setProtectionMask(cv::Mat(request.height, request.width, CV_8UC1, protect->data()));
+    if (remove) carver.setRemovalMask(cv::Mat(request.height, request.width, CV_8UC1, remove->data()));
+    DaemonResponseHeader response = prepareCarver(carver, request, carver.image(), pool, options);
+
+    if (request.outputBytes < static_cast<size_t>(response.width) * response.height * pixelBytes) {
+        throw std::invalid_argument("Output segment is too small for the target size");
+    }
+    carver.setOutputBuffer(output.data(), response.width, response.height, 0);
+    carve(carver, request, response, client);
+    return response;
+}
+
+void serveConnection(Connection& connection, ThreadPool& pool, const DaemonOptions& options) {
+    try {
+        for (;;) {
+            DaemonRequestHeader request;
+            ReceivedFds received;
+            if (!readHeaderWithFds(connection.fd, request, received.fds)) {
+                break;
+            }
+            if (request.magic != DAEMON_REQUEST_MAGIC || request.version != DAEMON_PROTOCOL_VERSION) {
+                throw std::runtime_error("Bad request header (magic/version mismatch)");
+            }
+            bool shared = (request.flags & DAEMON_FLAG_SHARED_MEMORY) != 0;
+            if (!shared) {
+                if (!received.fds.empty()) {
+                    throw std::runtime_error("Unexpected file descriptors on a payload request");
+                }
+                if (request.imageBytes > options.maxPayloadBytes || request.protectBytes > options.maxPayloadBytes ||
+                    request.removeBytes > options.maxPayloadBytes) {
+                    throw std::runtime_error("Payload exceeds the daemon limit");
+                }
+                readPayload(connection.fd, connection.image, request.imageBytes);
+                readPayload(connection.fd, connection.protect, request.protectBytes);
+                readPayload(connection.fd, connection.remove, request.removeBytes);
+            }
+
+            DaemonResponseHeader response;
+            std::string message;
+            connection.output.clear();
+            try {
+                response = shared ? processSharedRequest(request, received.fds, pool, connection.fd, options)
+                                  : processRequest(request, connection, pool, options);
+            } catch (const RequestCancelled& e) {
+                response = DaemonResponseHeader();
+                response.status = DAEMON_STATUS_CANCELLED;
+                message = e.what();
+                connection.output.clear();
+            } catch (const std::exception& e) {
+                response = DaemonResponseHeader();
+                response.status = DAEMON_STATUS_ERROR;
+                message = e.what();
+                connection.output.clear();
+            }
+            // Shared-memory results are already in the client's output segment.
+            response.imageBytes = connection.output.size();
+            response.messageBytes = message.size();
+
+            writeFully(connection.fd, &response, sizeof(response));
+            writeFully(connection.fd, connection.output.data(), connection.output.size());
+            writeFully(connection.fd, message.data(), message.size());
+        }
+    } catch (const std::exception& e) {
+        if (!g_stopRequested) {
+            std::string error = e.what();
+            defaultLogger().warning([&] { return "Daemon connection error: " + error; });
+        }
+    }
+    ::close(connection.fd);
+    connection.finished = true;
+}
+
+} // namespace
+
+int runDaemon(const DaemonOptions& options) {
+    // The pool owns all parallelism; OpenCV's own threads would oversubscribe.
+    cv::setNumThreads(1);
+    ::signal(SIGPIPE, SIG_IGN);
+    ThreadPool pool(options.jobs > 0 ? static_cast<unsigned>(options.jobs) : 0u);
+
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        throw std::runtime_error(std::string("socket failed: ") + std::strerror(errno));
+    }
+    sockaddr_un address = socketAddress(options.socketPath);
+    ::unlink(options.socketPath.c_str());
+    if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || ::listen(listener, 64) < 0) {
+        std::string error = std::strerror(errno);
+        ::close(listener);
+        throw std::runtime_error("Could not listen on " + options.socketPath + ": " + error);
+    }
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = onStopSignal;
+    ::sigaction(SIGINT, &action, nullptr);
+    ::sigaction(SIGTERM, &action, nullptr);
+
+    std::cout << "Daemon listening on " << options.socketPath << " with " << pool.size() << " thread(s)" << std::endl;
+
+    std::list<std::unique_ptr<Connection>> connections;
+    while (!g_stopRequested) {
+        // Reap finished connections so their threads do not accumulate.
+        for (auto it = connections.begin(); it != connections.end();) {
+            if ((*it)->finished) {
+                (*it)->thread.join();
+                it = connections.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        pollfd poller = {listener, POLLIN, 0};
+        if (::poll(&poller, 1, 200) <= 0) {
+            continue;
+        }
+        int client = ::accept(listener, nullptr, nullptr);
+        if (client < 0) {
+            continue;
+        }
+
+        connections.emplace_back(new Connection);
+        Connection& connection = *connections.back();
+        connection.fd = client;
+        connection.thread = std::thread([&connection, &pool, &options] { serveConnection(connection, pool, options); });
+    }
+
+    std::cout << "Daemon shutting down..." << std::endl;
+    ::close(listener);
+    ::unlink(options.socketPath.c_str());
+    for (auto& connection : connections) {
+        if (!connection->finished) {
+            ::shutdown(connection->fd, SHUT_RDWR);
+        }
+        connection->thread.join();
+    }
+    return 0;
+}
+
+// ---
+// Shared memory
+// ---
+
+SharedImage::SharedImage(size_t bytes) : m_size(bytes) {
+#ifdef __linux__
+    m_fd = ::memfd_create("seam_carver", MFD_CLOEXEC);
+#else
+    std::string name = "/seam_carver." + std::to_string(::getpid()) + "." + std::to_string(reinterpret_cast<uintptr_t>(this));
+    m_fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (m_fd >= 0) {
+        ::shm_unlink(name.c_str());
+    }
+#endif
+    if (m_fd < 0 || ::ftruncate(m_fd, static_cast<off_t>(bytes)) < 0) {
+        std::string error = std::strerror(errno);
+        if (m_fd >= 0) ::close(m_fd);
+        throw std::runtime_error("Could not create shared-memory segment: " + error);
+    }
+    m_data = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (m_data == MAP_FAILED) {
+        std::string error = std::strerror(errno);
+        ::close(m_fd);
+        throw std::runtime_error("Could not map shared-memory segment: " + error);
+    }
+}
+
+SharedImage::~SharedImage() {
+    ::munmap(m_data, m_size);
+    ::close(m_fd);
+}
+
+// ---
+// Client
+// ---
+
+DaemonClient::DaemonClient(const std::string& socketPath) {
+    m_socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_socket < 0) {
+        throw std::runtime_error(std::string("socket failed: ") + std::strerror(errno));
+    }
+    sockaddr_un address = socketAddress(socketPath);
+    if (::connect(m_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        std::string error = std::strerror(errno);
+        ::close(m_socket);
+        m_socket = -1;
+        throw std::runtime_error("Could not connect to daemon at " + socketPath + ": " + error);
+    }
+}
+
+DaemonClient::~DaemonClient() {
+    if (m_socket >= 0) {
+        ::close(m_socket);
+    }
+}
+
+DaemonResult DaemonClient::resize(const DaemonJob& job) {
+    DaemonRequestHeader header = job.header;
+    header.magic = DAEMON_REQUEST_MAGIC;
+    header.version = DAEMON_PROTOCOL_VERSION;
+    header.imageBytes = job.image.size();
+    header.protectBytes = job.protectMask.size();
+    header.removeBytes = job.removeMask.size();
+
+    writeFully(m_socket, &header, sizeof(header));
+    writeFully(m_socket, job.image.data(), job.image.size());
+    writeFully(m_socket, job.protectMask.data(), job.protectMask.size());
+    writeFully(m_socket, job.removeMask.data(), job.removeMask.size());
+
+    return readResponse();
+}
+
+DaemonResult DaemonClient::resize(DaemonRequestHeader header, const SharedImage& image, SharedImage& output,
+                                  const SharedImage* protectMask, const SharedImage* removeMask) {
+    header.magic = DAEMON_REQUEST_MAGIC;
+    header.version = DAEMON_PROTOCOL_VERSION;
+    header.flags |= DAEMON_FLAG_SHARED_MEMORY;
+    header.imageBytes = image.size();
+    header.outputBytes = output.size();
+    header.protectBytes = protectMask ? protectMask->size() : 0;
+    header.removeBytes = removeMask ? removeMask->size() : 0;
+
+    std::vector<int> fds = {image.fd(), output.fd()};
+    if (protectMask) fds.push_back(protectMask->fd());
+    if (removeMask) fds.push_back(removeMask->fd());
+
+    writeHeaderWithFds(m_socket, header, fds);
+    return readResponse();
+}
+
+DaemonResult DaemonClient::readResponse() {
+    DaemonResult result;
+    if (!readFully(m_socket, &result.header, sizeof(result.header))) {
+        throw std::runtime_error("Daemon closed the connection");
+    }
+    if (result.header.magic != DAEMON_RESPONSE_MAGIC) {
+        throw std::runtime_error("Bad response header from daemon");
+    }
+    readPayload(m_socket, result.image, result.header.imageBytes);
+    std::vector<unsigned char> message;
+    readPayload(m_socket, message, result.header.messageBytes);
+    result.message.assign(message.begin(), message.end());
+    return result;
+}
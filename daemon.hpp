@@ -0,0 +1,183 @@
+/**
+ * @file daemon.hpp
+ * @author Utkarsh Sachan
+ * @brief Resident resize daemon over a local Unix domain socket (POSIX only).
+ *
+ * The daemon keeps OpenCV loaded and a thread pool warm, and serves resize
+ * jobs over a stream socket. Each connection may send any number of requests;
+ * each request gets exactly one response.
+ *
+ * Wire format (native endianness; both ends are on the same machine):
+ *
+ *   request:  DaemonRequestHeader, image payload, protect payload, remove payload
+ *   response: DaemonResponseHeader, image payload, error message
+ *
+ * With `pixelFormat == DAEMON_ENCODED`, image and mask payloads are encoded
+ * files (JPEG, PNG, ...) and the result is encoded with `outputExtension`.
+ * Otherwise they are tightly packed raw pixels (masks: 8-bit, same size as
+ * the image) and the result is raw pixels in the same format.
+ *
+ * With `DAEMON_FLAG_SHARED_MEMORY` (raw formats only), no payloads follow the
+ * headers. Instead the request header carries file descriptors (SCM_RIGHTS)
+ * for shared-memory segments: input, output, then the protect and remove
+ * masks if their sizes are non-zero. The daemon maps them, reads the input in
+ * place and carves the final step straight into the output segment.
+ *
+ * A carve stops early, without a result, when the request's timeout expires
+ * (DAEMON_STATUS_CANCELLED) or when the client disconnects.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "energy.hpp"
+
+const uint32_t DAEMON_REQUEST_MAGIC = 0x53435251;  // "SCRQ"
+const uint32_t DAEMON_RESPONSE_MAGIC = 0x53435253; // "SCRS"
+const uint32_t DAEMON_PROTOCOL_VERSION = 3;
+const int32_t DAEMON_ENCODED = -1;
+const uint32_t DAEMON_FLAG_SHARED_MEMORY = 1u << 0;
+
+const int32_t DAEMON_STATUS_OK = 0;
+const int32_t DAEMON_STATUS_ERROR = -1;
+const int32_t DAEMON_STATUS_CANCELLED = -2; ///< The request's timeout expired.
+
+/**
+ * @brief Fixed-size request header, followed by the payloads it describes.
+ */
+struct DaemonRequestHeader {
+    uint32_t magic = DAEMON_REQUEST_MAGIC;
+    uint32_t version = DAEMON_PROTOCOL_VERSION;
+    uint32_t flags = 0; ///< DAEMON_FLAG_* bits.
+    int32_t targetWidth = -1;  ///< -1 keeps the original width.
+    int32_t targetHeight = -1; ///< -1 keeps the original height.
+    int32_t energy = static_cast<int32_t>(EnergyFunction::Sobel5);
+    int32_t pixelFormat = DAEMON_ENCODED; ///< DAEMON_ENCODED or a PixelFormat value.
+    int32_t width = 0;                    ///< Raw payloads only.
+    int32_t height = 0;                   ///< Raw payloads only.
+    uint32_t timeoutMilliseconds = 0;     ///< Abandon the carve after this long (0 = no limit).
+    uint64_t imageBytes = 0;
+    uint64_t protectBytes = 0;
+    uint64_t removeBytes = 0;
+    uint64_t outputBytes = 0; ///< Size of the output segment (shared memory only).
+    char outputExtension[8] = ".png"; ///< Encoding of the result (encoded mode).
+};
+
+/**
+ * @brief Fixed-size response header, followed by the result and an error message.
+ */
+struct DaemonResponseHeader {
+    uint32_t magic = DAEMON_RESPONSE_MAGIC;
+    int32_t status = DAEMON_STATUS_OK; ///< DAEMON_STATUS_*; the message explains failures.
+    int32_t width = 0;
+    int32_t height = 0;
+    int32_t pixelFormat = DAEMON_ENCODED;
+    uint64_t imageBytes = 0;
+    uint64_t messageBytes = 0;
+};
+
+/**
+ * @brief Settings for the daemon.
+ */
+struct DaemonOptions {
+    std::string socketPath;
+    int jobs = 0; ///< Pool threads (0 = hardware concurrency).
+    uint64_t maxPayloadBytes = 512ull * 1024 * 1024;
+    int maxEnlargement = 4; ///< Largest target side, as a multiple of the input side.
+    uint64_t maxOutputPixels = 256ull << 20; ///< Largest target area in pixels.
+};
+
+/**
+ * @brief Serves requests until SIGINT/SIGTERM. Removes the socket file on exit.
+ * @return 0 on clean shutdown.
+ */
+int runDaemon(const DaemonOptions& options);
+
+/**
+ * @brief A client-side request for DaemonClient::resize().
+ */
+struct DaemonJob {
+    DaemonRequestHeader header;
+    std::vector<unsigned char> image;
+    std::vector<unsigned char> protectMask;
+    std::vector<unsigned char> removeMask;
+};
+
+/**
+ * @brief A client-side response from DaemonClient::resize().
+ */
+struct DaemonResult {
+    DaemonResponseHeader header;
+    std::vector<unsigned char> image;
+    std::string message;
+};
+
+/**
+ * @class SharedImage
+ * @brief An anonymous shared-memory segment that can be handed to the daemon
+ * without copying (memfd on Linux, an immediately unlinked shm_open elsewhere).
+ */
+class SharedImage {
+public:
+    /**
+     * @brief Creates and maps a zero-filled segment.
+     * @throws std::runtime_error if the segment cannot be created.
+     */
+    explicit SharedImage(size_t bytes);
+    ~SharedImage();
+
+    SharedImage(const SharedImage&) = delete;
+    SharedImage& operator=(const SharedImage&) = delete;
+
+    void* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    int fd() const { return m_fd; }
+
+private:
+    int m_fd = -1;
+    void* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+/**
+ * @class DaemonClient
+ * @brief A connection to a running daemon; reuse it for many jobs.
+ */
+class DaemonClient {
+public:
+    /**
+     * @brief Connects to the daemon socket.
+     * @throws std::runtime_error if the daemon is not reachable.
+     */
+    explicit DaemonClient(const std::string& socketPath);
+    ~DaemonClient();
+
+    DaemonClient(const DaemonClient&) = delete;
+    DaemonClient& operator=(const DaemonClient&) = delete;
+
+    /**
+     * @brief Sends one job and waits for its response.
+     * @throws std::runtime_error on I/O or protocol errors (not on job failures,
+     * which are reported through the response status and message).
+     */
+    DaemonResult resize(const DaemonJob& job);
+
+    /**
+     * @brief Sends a raw job whose pixels live in shared memory (no payload copy).
+     *
+     * `header.pixelFormat`, `width` and `height` describe `image`; masks are
+     * optional 8-bit segments of the same size. On success the result is in
+     * `output`, which must hold at least target width x height pixels.
+     * @throws std::runtime_error on I/O or protocol errors.
+     */
+    DaemonResult resize(DaemonRequestHeader header, const SharedImage& image, SharedImage& output,
+                        const SharedImage* protectMask = nullptr, const SharedImage* removeMask = nullptr);
+
+private:
+    int m_socket = -1;
+
+    DaemonResult readResponse();
+};
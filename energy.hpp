@@ -0,0 +1,278 @@
+/**
+ * @file energy.hpp
+ * @author Utkarsh Sachan
+ * @brief Compile-time energy policies for the seam carver.
+ *
+ * Each policy is a stateless struct exposing:
+ * - `static const char* name()`  - the CLI name of the policy.
+ * - `static void compute(const cv::Mat& image, cv::Mat& energy)` - fills
+ *   `energy` with a CV_64F map normalized to the 0-255 range.
+ *
+ * `SeamCarver` dispatches on the selected `EnergyFunction` once per resize
+ * and instantiates the carving loops for the chosen policy, so there is no
+ * virtual call (or switch) inside the per-seam work.
+ *
+ * Available policies:
+ * - Sobel3, Sobel5, Scharr: grayscale gradient magnitude.
+ * - DualGradient: squared central differences summed over all channels.
+ *   Several times cheaper than a 5x5 Sobel; good for bulk catalogs.
+ * - RGBGradient: 3x3 Sobel magnitude per channel, summed.
+ * - Entropy: gradient magnitude plus 9x9 local entropy.
+ * - Saliency: gradient magnitude weighted by spectral-residual saliency.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief The energy functions selectable at runtime (e.g. via `--energy`).
+ * The order matches `sc_energy` in seam_carver_c.h.
+ */
+enum class EnergyFunction {
+    Sobel3,
+    Sobel5,
+    Scharr,
+    DualGradient,
+    RGBGradient,
+    Entropy,
+    Saliency
+};
+
+/**
+ * @brief Parses a CLI energy name ("sobel3", "sobel5", "scharr", "dual",
+ * "rgb", "entropy", "saliency").
+ * @throws std::invalid_argument for unknown names.
+ */
+inline EnergyFunction parseEnergyFunction(const std::string& name) {
+    if (name == "sobel3") return EnergyFunction::Sobel3;
+    if (name == "sobel5" || name == "sobel") return EnergyFunction::Sobel5;
+    if (name == "scharr") return EnergyFunction::Scharr;
+    if (name == "dual" || name == "dual-gradient") return EnergyFunction::DualGradient;
+    if (name == "rgb" || name == "rgb-gradient") return EnergyFunction::RGBGradient;
+    if (name == "entropy") return EnergyFunction::Entropy;
+    if (name == "saliency") return EnergyFunction::Saliency;
+    throw std::invalid_argument("Unknown energy function: " + name);
+}
+
+namespace energy_detail {
+
+/**
+ * @brief Converts an image with 1, 3 or 4 channels to a single-channel image.
+ */
+inline void toGray(const cv::Mat& image, cv::Mat& gray) {
+    switch (image.channels()) {
+        case 1: gray = image; break;
+        case 3: cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY); break;
+        case 4: cv::cvtColor(image, gray, cv::COLOR_BGRA2GRAY); break;
+        default: throw std::invalid_argument("Unsupported channel count for energy computation.");
+    }
+}
+
+/**
+ * @brief Computes sqrt(gx^2 + gy^2) into a CV_64F map.
+ */
+inline void gradientMagnitude(const cv::Mat& gx, const cv::Mat& gy, cv::Mat& energy) {
+    cv::Mat gx_sq, gy_sq;
+    cv::multiply(gx, gx, gx_sq);
+    cv::multiply(gy, gy, gy_sq);
+    cv::sqrt(gx_sq + gy_sq, energy);
+}
+
+/**
+ * @brief Grayscale Sobel magnitude with the given kernel size.
+ */
+inline void sobelEnergy(const cv::Mat& image, cv::Mat& energy, int ksize) {
+    cv::Mat gray, grad_x, grad_y;
+    toGray(image, gray);
+    cv::Sobel(gray, grad_x, CV_64F, 1, 0, ksize);
+    cv::Sobel(gray, grad_y, CV_64F, 0, 1, ksize);
+    gradientMagnitude(grad_x, grad_y, energy);
+    cv::normalize(energy, energy, 0, 255, cv::NORM_MINMAX);
+}
+
+/**
+ * @brief Dual-gradient energy on channel type T with replicated borders.
+ */
+template <typename T>
+void dualGradient(const cv::Mat& image, cv::Mat& energy) {
+    const int rows = image.rows;
+    const int cols = image.cols;
+    const int cn = image.channels();
+    energy.create(rows, cols, CV_64F);
+
+    for (int r = 0; r < rows; ++r) {
+        const T* up = image.ptr<T>(r > 0 ? r - 1 : r);
+        const T* mid = image.ptr<T>(r);
+        const T* down = image.ptr<T>(r < rows - 1 ? r + 1 : r);
+        double* out = energy.ptr<double>(r);
+
+        for (int c = 0; c < cols; ++c) {
+            const int left = (c > 0 ? c - 1 : c) * cn;
+            const int right = (c < cols - 1 ? c + 1 : c) * cn;
+            const int here = c * cn;
+            double sum = 0.0;
+            for (int k = 0; k < cn; ++k) {
+                const double dx = static_cast<double>(mid[right + k]) - mid[left + k];
+                const double dy = static_cast<double>(down[here + k]) - up[here + k];
+                sum += dx * dx + dy * dy;
+            }
+            out[c] = std::sqrt(sum);
+        }
+    }
+    cv::normalize(energy, energy, 0, 255, cv::NORM_MINMAX);
+}
+
+} // namespace energy_detail
+
+/** @brief Grayscale 3x3 Sobel magnitude. */
+struct Sobel3Energy {
+    static const char* name() { return "sobel3"; }
+    static void compute(const cv::Mat& image, cv::Mat& energy) {
+        energy_detail::sobelEnergy(image, energy, 3);
+    }
+};
+
+/** @brief Grayscale 5x5 Sobel magnitude (the original default). */
+struct Sobel5Energy {
+    static const char* name() { return "sobel5"; }
+    static void compute(const cv::Mat& image, cv::Mat& energy) {
+        energy_detail::sobelEnergy(image, energy, 5);
+    }
+};
+
+/** @brief Grayscale 3x3 Scharr magnitude (better rotational symmetry than Sobel3). */
+struct ScharrEnergy {
+    static const char* name() { return "scharr"; }
+    static void compute(const cv::Mat& image, cv::Mat& energy) {
+        cv::Mat gray, grad_x, grad_y;
+        energy_detail::toGray(image, gray);
+        cv::Scharr(gray, grad_x, CV_64F, 1, 0);
+        cv::Scharr(gray, grad_y, CV_64F, 0, 1);
+        energy_detail::gradientMagnitude(grad_x, grad_y, energy);
+        cv::normalize(energy, energy, 0, 255, cv::NORM_MINMAX);
+    }
+};
+
+/** @brief Central-difference gradient over all channels in a single pass. */
+struct DualGradientEnergy {
+    static const char* name() { return "dual"; }
+    static void compute(const cv::Mat& image, cv::Mat& energy) {
+        switch (image.depth()) {
+            case CV_8U: energy_detail::dualGradient<uchar>(image, energy); break;
+            case CV_16U: energy_detail::dualGradient<ushort>(image, energy); break;
+            default: throw std::invalid_argument("Unsupported image depth for dual-gradient energy.");
+        }
+    }
+};
+
+/** @brief Sum of 3x3 Sobel magnitudes computed independently per color channel (alpha is ignored). */
+struct RGBGradientEnergy {
+    static const char* name() { return "rgb"; }
+    static void compute(const cv::Mat& image, cv::Mat& energy) {
+        std::vector<cv::Mat> channels;
+        cv::split(image, channels);
+        if (channels.size() == 4) channels.pop_back();
+        energy = cv::Mat::zeros(image.size(), CV_64F);
+
+        cv::Mat grad_x, grad_y, magnitude;
+        for (const cv::Mat& channel : channels) {
+            cv::Sobel(channel, grad_x, CV_64F, 1, 0, 3);
+            cv::Sobel(channel, grad_y, CV_64F, 0, 1, 3);
+            energy_detail::gradientMagnitude(grad_x, grad_y, magnitude);
+            energy += magnitude;
+        }
+        cv::normalize(energy, energy, 0, 255, cv::NORM_MINMAX);
+    }
+};
+
+/**
+ * @brief Gradient magnitude plus local (9x9) Shannon entropy.
+ *
+ * Entropy is computed from a 16-bin quantized histogram, using one box
+ * filter per bin to get the windowed bin probabilities.
+ */
+struct EntropyEnergy {
+    static const char* name() { return "entropy"; }
+    static void compute(const cv::Mat& image, cv::Mat& energy) {
+        const int bins = 16;
+        const cv::Size window(9, 9);
+
+        Sobel3Energy::compute(image, energy);
+
+        cv::Mat gray, gray8;
+        energy_detail::toGray(image, gray);
+        gray.convertTo(gray8, CV_8U, gray.depth() == CV_16U ? 1.0 / 257.0 : 1.0);
+
+        cv::Mat entropy = cv::Mat::zeros(image.size(), CV_64F);
+        cv::Mat indicator(image.size(), CV_64F);
+        cv::Mat probability;
+        for (int b = 0; b < bins; ++b) {
+            for (int r = 0; r < gray8.rows; ++r) {
+                const uchar* src = gray8.ptr<uchar>(r);
+                double* dst = indicator.ptr<double>(r);
+                for (int c = 0; c < gray8.cols; ++c) {
+                    dst[c] = (src[c] * bins / 256 == b) ? 1.0 : 0.0;
+                }
+            }
+            cv::boxFilter(indicator, probability, CV_64F, window);
+            for (int r = 0; r < entropy.rows; ++r) {
+                const double* p = probability.ptr<double>(r);
+                double* e = entropy.ptr<double>(r);
+                for (int c = 0; c < entropy.cols; ++c) {
+                    if (p[c] > 0.0) e[c] -= p[c] * std::log(p[c]);
+                }
+            }
+        }
+
+        cv::normalize(entropy, entropy, 0, 255, cv::NORM_MINMAX);
+        energy += entropy;
+        cv::normalize(energy, energy, 0, 255, cv::NORM_MINMAX);
+    }
+};
+
+/**
+ * @brief Gradient magnitude weighted by spectral-residual saliency
+ * (Hou & Zhang, 2007), computed on a 64-pixel-wide proxy.
+ */
+struct SaliencyEnergy {
+    static const char* name() { return "saliency"; }
+    static void compute(const cv::Mat& image, cv::Mat& energy) {
+        Sobel3Energy::compute(image, energy);
+
+        cv::Mat gray, small;
+        energy_detail::toGray(image, gray);
+        const int proxyWidth = 64;
+        const int proxyHeight = std::max(1, gray.rows * proxyWidth / std::max(1, gray.cols));
+        cv::resize(gray, small, cv::Size(proxyWidth, proxyHeight), 0, 0, cv::INTER_AREA);
+        small.convertTo(small, CV_32F);
+
+        // Spectral residual: log amplitude minus its local average, keeping phase.
+        cv::Mat spectrum, magnitude, phase, logAmplitude, smoothed, residual;
+        cv::dft(small, spectrum, cv::DFT_COMPLEX_OUTPUT);
+        std::vector<cv::Mat> planes;
+        cv::split(spectrum, planes);
+        cv::cartToPolar(planes[0], planes[1], magnitude, phase);
+        cv::log(magnitude + cv::Scalar(1e-6), logAmplitude);
+        cv::blur(logAmplitude, smoothed, cv::Size(3, 3));
+        cv::exp(logAmplitude - smoothed, residual);
+        cv::polarToCart(residual, phase, planes[0], planes[1]);
+        cv::merge(planes, spectrum);
+
+        cv::Mat saliency;
+        cv::idft(spectrum, saliency, cv::DFT_REAL_OUTPUT | cv::DFT_SCALE);
+        cv::multiply(saliency, saliency, saliency);
+        cv::GaussianBlur(saliency, saliency, cv::Size(9, 9), 2.5);
+        cv::normalize(saliency, saliency, 0.0, 1.0, cv::NORM_MINMAX);
+        cv::resize(saliency, saliency, image.size(), 0, 0, cv::INTER_LINEAR);
+        saliency.convertTo(saliency, CV_64F);
+
+        // Keep some gradient energy outside salient regions so seams stay smooth.
+        cv::multiply(energy, saliency * 0.75 + cv::Scalar(0.25), energy);
+        cv::normalize(energy, energy, 0, 255, cv::NORM_MINMAX);
+    }
+};
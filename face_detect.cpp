@@ -0,0 +1,212 @@
+/**
+ * @file face_detect.cpp
+ * @author Utkarsh Sachan
+ * @brief Implementation of in-process face detection (see face_detect.hpp).
+ */
+
+#include "face_detect.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace {
+
+// Where OpenCV installs its Haar cascades (Homebrew, /usr/local, distro packages, OpenCV 3).
+const char* const DEFAULT_CASCADE_PATHS[] = {
+    "/opt/homebrew/share/opencv4/haarcascades/haarcascade_frontalface_default.xml",
+    "/usr/local/share/opencv4/haarcascades/haarcascade_frontalface_default.xml",
+    "/usr/share/opencv4/haarcascades/haarcascade_frontalface_default.xml",
+    "/opt/homebrew/share/OpenCV/haarcascades/haarcascade_frontalface_default.xml",
+    "/usr/local/share/OpenCV/haarcascades/haarcascade_frontalface_default.xml"
+};
+
+// Grow each detected face by this share of its size on every side.
+const double FACE_MARGIN = 0.2;
+
+// Rectangles whose sides differ by less than this share are merged (detectMultiScale's GROUP_EPS).
+const double GROUP_EPS = 0.2;
+
+/**
+ * @brief Converts any supported image to the 8-bit, equalized gray image the
+ * cascade expects, area-downscaled by `scale` (at most 1).
+ */
+cv::Mat detectionGray(const cv::Mat& image, double scale) {
+    cv::Mat gray = image;
+    if (scale < 1.0) {
+        // Shrink first: every later step then runs on the small image.
+        cv::Size size(std::max(1, static_cast<int>(std::lround(image.cols * scale))),
+                      std::max(1, static_cast<int>(std::lround(image.rows * scale))));
+        cv::resize(image, gray, size, 0, 0, cv::INTER_AREA);
+    }
+    if (gray.channels() == 3) {
+        cv::cvtColor(gray, gray, cv::COLOR_BGR2GRAY);
+    } else if (gray.channels() == 4) {
+        cv::cvtColor(gray, gray, cv::COLOR_BGRA2GRAY);
+    }
+    if (gray.depth() != CV_8U) {
+        gray.convertTo(gray, CV_8U, 1.0 / 257.0);
+    }
+    // Never equalize in place: `gray` may still share the caller's pixels.
+    cv::Mat equalized;
+    cv::equalizeHist(gray, equalized);
+    return equalized;
+}
+
+} // namespace
+
+// ---
+// FaceDetector
+// ---
+
+FaceDetector::FaceDetector(const std::string& cascadePath, const FaceDetectionOptions& options) : m_options(options) {
+    if (m_options.scaleStep <= 1.0 || m_options.minFaceFraction < 0.0 || m_options.maxSide < 0) {
+        throw std::invalid_argument("Invalid face detection options.");
+    }
+    std::unique_ptr<cv::CascadeClassifier> classifier(new cv::CascadeClassifier());
+    if (!cascadePath.empty()) {
+        if (!classifier->load(cascadePath)) {
+            throw std::runtime_error("Could not load Haar cascade: " + cascadePath);
+        }
+        m_cascadePath = cascadePath;
+    } else {
+        for (const char* path : DEFAULT_CASCADE_PATHS) {
+            if (classifier->load(path)) {
+                m_cascadePath = path;
+                break;
+            }
+        }
+        if (m_cascadePath.empty()) {
+            throw std::runtime_error("Could not find haarcascade_frontalface_default.xml in the usual OpenCV locations; "
+                                     "pass its path explicitly.");
+        }
+    }
+    m_idle.push_back(std::move(classifier));
+}
+
+const std::string& FaceDetector::cascadePath() const {
+    return m_cascadePath;
+}
+
+std::unique_ptr<cv::CascadeClassifier> FaceDetector::acquire() const {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_idle.empty()) {
+            std::unique_ptr<cv::CascadeClassifier> classifier = std::move(m_idle.back());
+            m_idle.pop_back();
+            return classifier;
+        }
+    }
+    // All classifiers are busy on other threads: load one more, outside the lock.
+    std::unique_ptr<cv::CascadeClassifier> classifier(new cv::CascadeClassifier());
+    if (!classifier->load(m_cascadePath)) {
+        throw std::runtime_error("Could not load Haar cascade: " + m_cascadePath);
+    }
+    return classifier;
+}
+
+void FaceDetector::release(std::unique_ptr<cv::CascadeClassifier> classifier) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_idle.push_back(std::move(classifier));
+}
+
+std::vector<cv::Rect> FaceDetector::detect(const cv::Mat& image) const {
+    const int longerSide = std::max(image.cols, image.rows);
+    const double scale = (m_options.maxSide > 0 && longerSide > m_options.maxSide)
+                             ? static_cast<double>(m_options.maxSide) / longerSide : 1.0;
+    const cv::Mat gray = detectionGray(image, scale);
+
+    // Pyramid levels, from the smallest face size up: level i looks for faces
+    // of window * levels[i] pixels by shrinking the image by levels[i].
+    std::unique_ptr<cv::CascadeClassifier> first = acquire();
+    const cv::Size window = first->getOriginalWindowSize();
+    release(std::move(first));
+    const double minFace = m_options.minFaceFraction * std::min(gray.cols, gray.rows);
+    std::vector<double> levels;
+    for (double factor = std::max(1.0, minFace / window.width);
+         gray.cols / factor >= window.width && gray.rows / factor >= window.height; factor *= m_options.scaleStep) {
+        levels.push_back(factor);
+    }
+
+    // Threads take levels largest-image first, so the costly ones start early.
+    std::vector<cv::Rect> hits;
+    std::mutex hitsMutex;
+    std::atomic<size_t> nextLevel{0};
+    std::exception_ptr failure;
+    auto worker = [&] {
+        std::unique_ptr<cv::CascadeClassifier> classifier;
+        try {
+            classifier = acquire();
+            std::vector<cv::Rect> found;
+            for (size_t i = nextLevel.fetch_add(1); i < levels.size(); i = nextLevel.fetch_add(1)) {
+                const double factor = levels[i];
+                cv::Mat level;
+                cv::resize(gray, level, cv::Size(static_cast<int>(gray.cols / factor), static_cast<int>(gray.rows / factor)),
+                           0, 0, cv::INTER_LINEAR);
+                // minSize == maxSize == window: one scale, no grouping yet.
+                classifier->detectMultiScale(level, found, m_options.scaleStep, 0, 0, window, window);
+                std::lock_guard<std::mutex> lock(hitsMutex);
+                for (const cv::Rect& hit : found) {
+                    hits.emplace_back(static_cast<int>(std::lround(hit.x * factor)), static_cast<int>(std::lround(hit.y * factor)),
+                                      static_cast<int>(std::lround(hit.width * factor)),
+                                      static_cast<int>(std::lround(hit.height * factor)));
+                }
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(hitsMutex);
+            failure = std::current_exception();
+        }
+        if (classifier) {
+            release(std::move(classifier));
+        }
+    };
+
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    const size_t threads = std::min(levels.size(), static_cast<size_t>(m_options.threads > 0 ? m_options.threads : cores));
+    std::vector<std::thread> helpers;
+    for (size_t i = 1; i < threads; ++i) {
+        helpers.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& helper : helpers) {
+        helper.join();
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+
+    // Merge the hits of neighboring positions and levels into faces, then
+    // map them back to the input image.
+    cv::groupRectangles(hits, m_options.minNeighbors, GROUP_EPS);
+    std::vector<cv::Rect> faces;
+    for (const cv::Rect& hit : hits) {
+        faces.emplace_back(static_cast<int>(hit.x / scale), static_cast<int>(hit.y / scale),
+                           static_cast<int>(hit.width / scale), static_cast<int>(hit.height / scale));
+    }
+    return faces;
+}
+
+std::vector<MaskShape> FaceDetector::faceShapes(const std::vector<cv::Rect>& faces, const cv::Size& size) {
+    std::vector<MaskShape> shapes;
+    const cv::Rect bounds(0, 0, size.width, size.height);
+    for (const cv::Rect& face : faces) {
+        const int marginX = static_cast<int>(face.width * FACE_MARGIN);
+        const int marginY = static_cast<int>(face.height * FACE_MARGIN);
+        MaskShape shape;
+        shape.mode = MaskMode::Protect;
+        shape.rect = cv::Rect(face.x - marginX, face.y - marginY, face.width + 2 * marginX, face.height + 2 * marginY) & bounds;
+        shapes.push_back(shape);
+    }
+    return shapes;
+}
+
+cv::Mat FaceDetector::faceMask(const std::vector<cv::Rect>& faces, const cv::Size& size) {
+    cv::Mat mask = cv::Mat::zeros(size, CV_8UC1);
+    for (const MaskShape& shape : faceShapes(faces, size)) {
+        cv::rectangle(mask, shape.rect, cv::Scalar(255), -1);
+    }
+    return mask;
+}
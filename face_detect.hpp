@@ -0,0 +1,112 @@
+/**
+ * @file face_detect.hpp
+ * @author Utkarsh Sachan
+ * @brief In-process face detection for protection masks (`--auto-protect=faces`).
+ *
+ * Loading a Haar cascade parses a megabyte of XML, so a FaceDetector is meant
+ * to be created once and shared: by the CLI for one image, by batch mode for
+ * every entry. Detection runs on the image the carver already decoded, and
+ * the faces go straight into SeamCarver::addMaskShapes() as rectangles, with
+ * no separate process, PNG round trip, second decode or full-size mask.
+ */
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "seam_carver.hpp"
+#include "vector_mask.hpp"
+
+/**
+ * @brief How FaceDetector searches an image.
+ */
+struct FaceDetectionOptions {
+    /// Detect on a copy whose longer side is at most this many pixels and
+    /// scale the faces back (0 = full resolution). Haar features need only a
+    /// few dozen pixels per face, so this costs little recall.
+    int maxSide = 1024;
+    /// Smallest face to look for, as a share of the image's shorter side.
+    /// The default finds faces down to 1/25 of a portrait's width.
+    double minFaceFraction = 0.04;
+    double scaleStep = 1.1; ///< Size ratio between pyramid levels.
+    int minNeighbors = 3;   ///< Overlapping hits needed to keep a face.
+    int threads = 0;        ///< Threads sharing the pyramid levels (0 = all cores).
+};
+
+/**
+ * @class FaceDetector
+ * @brief A loaded frontal-face cascade, safe to share between threads.
+ *
+ * cv::CascadeClassifier is not safe for concurrent detection, so the
+ * detector keeps a small set of loaded classifiers. Each detect() call
+ * borrows one, loading another only when all are busy. Loads therefore
+ * happen at most once per concurrently detecting thread, not once per image.
+ */
+class FaceDetector {
+public:
+    /**
+     * @brief Loads the cascade.
+     * @param cascadePath Cascade XML file; empty searches the usual OpenCV
+     * install locations for haarcascade_frontalface_default.xml.
+     * @throws std::runtime_error if no cascade can be loaded.
+     */
+    explicit FaceDetector(const std::string& cascadePath = std::string(),
+                          const FaceDetectionOptions& options = FaceDetectionOptions());
+
+    /**
+     * @brief The cascade file in use.
+     */
+    const std::string& cascadePath() const;
+
+    /**
+     * @brief Detects faces in an 8/16-bit image with 1, 3 or 4 channels.
+     *
+     * The image is area-downscaled to the options' maxSide, then searched
+     * one pyramid level at a time, like cv::CascadeClassifier::detectMultiScale
+     * but with the levels spread over threads, each with its own classifier.
+     * The hits of all levels are grouped as detectMultiScale groups them.
+     * @return Face rectangles in image coordinates.
+     */
+    std::vector<cv::Rect> detect(const cv::Mat& image) const;
+
+    /**
+     * @brief Turns faces into protected rectangles within an image of the given size.
+     * Each rectangle is grown by 20% on every side, since the cascade boxes
+     * are tight and seams just outside them still distort the head.
+     */
+    static std::vector<MaskShape> faceShapes(const std::vector<cv::Rect>& faces, const cv::Size& size);
+
+    /**
+     * @brief Rasterizes faceShapes() into a protection mask of the given size.
+     */
+    static cv::Mat faceMask(const std::vector<cv::Rect>& faces, const cv::Size& size);
+
+private:
+    std::unique_ptr<cv::CascadeClassifier> acquire() const;
+    void release(std::unique_ptr<cv::CascadeClassifier> classifier) const;
+
+    std::string m_cascadePath;
+    FaceDetectionOptions m_options;
+    mutable std::mutex m_mutex;
+    mutable std::vector<std::unique_ptr<cv::CascadeClassifier>> m_idle;
+};
+
+/**
+ * @brief Detects faces in the carver's image and adds them to its protection mask.
+ * Inline, so tools that only detect (create_face_mask) need not link the carver.
+ * @return The number of faces found.
+ */
+inline int protectFaces(SeamCarver& carver, const FaceDetector& detector) {
+    const cv::Mat& image = carver.image();
+    std::vector<cv::Rect> faces = detector.detect(image);
+    if (faces.empty()) {
+        return 0;
+    }
+    // Added to any protection the caller already set.
+    carver.addMaskShapes(FaceDetector::faceShapes(faces, image.size()));
+    return static_cast<int>(faces.size());
+}
@@ -0,0 +1,162 @@
+/**
+ * @file image_probe.hpp
+ * @author Utkarsh Sachan
+ * @brief Reads image dimensions from file headers without decoding pixels.
+ *
+ * Probing reads a few hundred bytes at most (JPEG: the marker segments up to
+ * the frame header), so it is cheap enough to validate millions of files.
+ * Recognized formats are JPEG, PNG, WebP and TIFF; for anything else callers
+ * fall back to decoding.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <opencv2/opencv.hpp>
+
+namespace image_probe_detail {
+
+inline bool readBytes(std::istream& in, unsigned char* data, size_t count) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(count)));
+}
+
+inline uint32_t bigEndian(const unsigned char* p, int bytes) {
+    uint32_t value = 0;
+    for (int i = 0; i < bytes; ++i) value = (value << 8) | p[i];
+    return value;
+}
+
+inline uint32_t littleEndian(const unsigned char* p, int bytes) {
+    uint32_t value = 0;
+    for (int i = bytes - 1; i >= 0; --i) value = (value << 8) | p[i];
+    return value;
+}
+
+/**
+ * @brief Reads the TIFF structure at `base` (a TIFF file, or a JPEG's EXIF
+ * block) and returns IFD0's width, height and orientation tags if present.
+ */
+inline bool readTiffTags(std::istream& in, std::streamoff base, uint32_t& width, uint32_t& height, uint32_t& orientation) {
+    unsigned char header[8];
+    in.seekg(base);
+    if (!readBytes(in, header, sizeof(header))) return false;
+    bool little = (header[0] == 'I' && header[1] == 'I');
+    if (!little && !(header[0] == 'M' && header[1] == 'M')) return false;
+    auto read = [little](const unsigned char* p, int bytes) { return little ? littleEndian(p, bytes) : bigEndian(p, bytes); };
+    if (read(header + 2, 2) != 42) return false;
+
+    unsigned char count[2];
+    in.seekg(base + read(header + 4, 4));
+    if (!readBytes(in, count, sizeof(count))) return false;
+    for (uint32_t i = 0, n = read(count, 2); i < n; ++i) {
+        unsigned char entry[12]; // tag, type, count, value
+        if (!readBytes(in, entry, sizeof(entry))) return false;
+        uint32_t tag = read(entry, 2);
+        uint32_t value = (read(entry + 2, 2) == 3) ? read(entry + 8, 2) : read(entry + 8, 4); // SHORT or LONG
+        if (tag == 256) width = value;
+        if (tag == 257) height = value;
+        if (tag == 274) orientation = value;
+    }
+    return true;
+}
+
+inline bool probeJpeg(std::istream& in, cv::Size& size) {
+    uint32_t orientation = 1;
+    unsigned char marker[2];
+    for (;;) {
+        // Markers are 0xFF followed by a code; extra 0xFF bytes are fill.
+        if (!readBytes(in, marker, 1) || marker[0] != 0xFF) return false;
+        do {
+            if (!readBytes(in, marker + 1, 1)) return false;
+        } while (marker[1] == 0xFF);
+        const unsigned char code = marker[1];
+        if (code == 0xD8 || code == 0x01 || (code >= 0xD0 && code <= 0xD7)) continue; // no payload
+        if (code == 0xD9 || code == 0xDA) return false; // end of image or scan data before a frame header
+
+        unsigned char length[2];
+        if (!readBytes(in, length, sizeof(length))) return false;
+        const std::streamoff payload = in.tellg();
+        const uint32_t segmentBytes = bigEndian(length, 2);
+        if (segmentBytes < 2) return false;
+
+        // SOF0-SOF15 except DHT (C4), JPG (C8) and DAC (CC).
+        if (code >= 0xC0 && code <= 0xCF && code != 0xC4 && code != 0xC8 && code != 0xCC) {
+            unsigned char frame[5]; // precision, height, width
+            if (!readBytes(in, frame, sizeof(frame))) return false;
+            size = cv::Size(static_cast<int>(bigEndian(frame + 3, 2)), static_cast<int>(bigEndian(frame + 1, 2)));
+            // imread applies EXIF orientation; 5-8 are the rotations by 90 degrees.
+            if (orientation >= 5 && orientation <= 8) size = cv::Size(size.height, size.width);
+            return size.area() > 0;
+        }
+        if (code == 0xE1 && segmentBytes >= 16) {
+            unsigned char exif[6];
+            uint32_t unusedWidth = 0, unusedHeight = 0;
+            if (readBytes(in, exif, sizeof(exif)) && std::string(reinterpret_cast<char*>(exif), 6) == std::string("Exif\0\0", 6)) {
+                readTiffTags(in, payload + 6, unusedWidth, unusedHeight, orientation);
+            }
+            in.clear();
+        }
+        in.seekg(payload + static_cast<std::streamoff>(segmentBytes - 2));
+    }
+}
+
+inline bool probeWebp(std::istream& in, cv::Size& size) {
+    unsigned char chunk[30]; // chunk header + enough of the bitstream header
+    if (!readBytes(in, chunk, sizeof(chunk))) return false;
+    const std::string fourcc(reinterpret_cast<char*>(chunk), 4);
+    const unsigned char* data = chunk + 8;
+    if (fourcc == "VP8 " && data[3] == 0x9D && data[4] == 0x01 && data[5] == 0x2A) {
+        size = cv::Size(static_cast<int>(littleEndian(data + 6, 2) & 0x3FFF), static_cast<int>(littleEndian(data + 8, 2) & 0x3FFF));
+    } else if (fourcc == "VP8L" && data[0] == 0x2F) {
+        uint32_t bits = littleEndian(data + 1, 4);
+        size = cv::Size(static_cast<int>((bits & 0x3FFF) + 1), static_cast<int>(((bits >> 14) & 0x3FFF) + 1));
+    } else if (fourcc == "VP8X") {
+        size = cv::Size(static_cast<int>(littleEndian(data + 4, 3) + 1), static_cast<int>(littleEndian(data + 7, 3) + 1));
+    } else {
+        return false;
+    }
+    return size.area() > 0;
+}
+
+} // namespace image_probe_detail
+
+/**
+ * @brief Reads an image's dimensions from its header, without decoding it.
+ *
+ * JPEG dimensions honor EXIF orientation, matching how SeamCarver loads
+ * JPEGs; PNG, WebP and TIFF are reported as stored.
+ * @param size Set to width x height on success.
+ * @return false if the file cannot be read or its format is not recognized.
+ */
+inline bool probeImageSize(const std::string& path, cv::Size& size) {
+    using namespace image_probe_detail;
+    std::ifstream in(path, std::ios::binary);
+    unsigned char magic[12] = {};
+    if (!in || !readBytes(in, magic, sizeof(magic))) {
+        return false;
+    }
+
+    if (magic[0] == 0xFF && magic[1] == 0xD8) {
+        in.seekg(0);
+        return probeJpeg(in, size);
+    }
+    if (bigEndian(magic, 4) == 0x89504E47 && bigEndian(magic + 4, 4) == 0x0D0A1A0A) {
+        unsigned char ihdr[16]; // length, "IHDR", width, height
+        in.seekg(8);
+        if (!readBytes(in, ihdr, sizeof(ihdr)) || std::string(reinterpret_cast<char*>(ihdr + 4), 4) != "IHDR") return false;
+        size = cv::Size(static_cast<int>(bigEndian(ihdr + 8, 4)), static_cast<int>(bigEndian(ihdr + 12, 4)));
+        return size.area() > 0;
+    }
+    if (std::string(reinterpret_cast<char*>(magic), 4) == "RIFF" && std::string(reinterpret_cast<char*>(magic + 8), 4) == "WEBP") {
+        return probeWebp(in, size);
+    }
+    if ((magic[0] == 'I' && magic[1] == 'I') || (magic[0] == 'M' && magic[1] == 'M')) {
+        uint32_t width = 0, height = 0, orientation = 1;
+        if (!readTiffTags(in, 0, width, height, orientation) || width == 0 || height == 0) return false;
+        size = cv::Size(static_cast<int>(width), static_cast<int>(height));
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,199 @@
+/**
+ * @file logging.hpp
+ * @author Utkarsh Sachan
+ * @brief Leveled logging for libseamcarver, silent by default.
+ *
+ * The library never writes to stdout/stderr directly. Messages go to a
+ * `Logger`, which is a no-op unless a `LogSink` is attached, and message text
+ * is only formatted when the level is enabled, so a silent logger costs one
+ * branch. Sinks never force a flush per message; `AsyncLogSink` additionally
+ * moves the write itself off the calling thread.
+ *
+ * Each `SeamCarver` copies the process-wide default logger (see
+ * setDefaultLogger()) when constructed; `SeamCarver::setLogger` overrides it.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+/**
+ * @brief Message severity, in increasing order.
+ */
+enum class LogLevel {
+    Debug,
+    Info,
+    Warning,
+    Error,
+    Off ///< As a minimum level: log nothing.
+};
+
+/**
+ * @brief Parses "debug", "info", "warning", "error" or "off".
+ * @throws std::invalid_argument for unknown names.
+ */
+inline LogLevel parseLogLevel(const std::string& name) {
+    if (name == "debug") return LogLevel::Debug;
+    if (name == "info") return LogLevel::Info;
+    if (name == "warning" || name == "warn") return LogLevel::Warning;
+    if (name == "error") return LogLevel::Error;
+    if (name == "off" || name == "none") return LogLevel::Off;
+    throw std::invalid_argument("Unknown log level: " + name + " (use debug, info, warning, error, off)");
+}
+
+/**
+ * @brief Destination of log messages. Implementations must be thread-safe.
+ */
+class LogSink {
+public:
+    virtual ~LogSink() = default;
+    virtual void write(LogLevel level, const std::string& message) = 0;
+};
+
+/**
+ * @brief Writes Info and below to stdout and Warning and above to stderr,
+ * prefixed like the CLI always did ("Warning: ..."), without flushing.
+ */
+class StreamLogSink : public LogSink {
+public:
+    void write(LogLevel level, const std::string& message) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (level >= LogLevel::Warning) {
+            std::cerr << (level == LogLevel::Error ? "Error: " : "Warning: ") << message << '\n';
+        } else {
+            std::cout << message << '\n';
+        }
+    }
+
+private:
+    std::mutex m_mutex;
+};
+
+/**
+ * @brief Queues messages and forwards them to another sink on a background
+ * thread, so logging never blocks on I/O in the request path.
+ * Pending messages are delivered before destruction completes.
+ */
+class AsyncLogSink : public LogSink {
+public:
+    explicit AsyncLogSink(std::shared_ptr<LogSink> target) : m_target(std::move(target)) {
+        m_thread = std::thread([this] { run(); });
+    }
+
+    ~AsyncLogSink() override {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_one();
+        m_thread.join();
+    }
+
+    AsyncLogSink(const AsyncLogSink&) = delete;
+    AsyncLogSink& operator=(const AsyncLogSink&) = delete;
+
+    void write(LogLevel level, const std::string& message) override {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.emplace_back(level, message);
+        }
+        m_wake.notify_one();
+    }
+
+private:
+    std::shared_ptr<LogSink> m_target;
+    std::deque<std::pair<LogLevel, std::string>> m_queue;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stop = false;
+    std::thread m_thread;
+
+    void run() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;) {
+            m_wake.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+            if (m_queue.empty()) return; // stopped and drained
+            std::deque<std::pair<LogLevel, std::string>> batch;
+            batch.swap(m_queue);
+            lock.unlock();
+            for (const auto& entry : batch) {
+                m_target->write(entry.first, entry.second);
+            }
+            lock.lock();
+        }
+    }
+};
+
+/**
+ * @class Logger
+ * @brief A cheap-to-copy handle to a sink and a minimum level.
+ * A default-constructed logger discards everything.
+ */
+class Logger {
+public:
+    Logger() = default;
+    explicit Logger(std::shared_ptr<LogSink> sink, LogLevel minLevel = LogLevel::Info)
+        : m_sink(std::move(sink)), m_minLevel(minLevel) {}
+
+    bool enabled(LogLevel level) const {
+        return m_sink && level >= m_minLevel && level != LogLevel::Off;
+    }
+
+    /**
+     * @brief Logs the message produced by `format()` if `level` is enabled.
+     * @param format Callable returning std::string; not called when disabled.
+     */
+    template <typename Format>
+    void log(LogLevel level, Format&& format) const {
+        if (enabled(level)) {
+            m_sink->write(level, format());
+        }
+    }
+
+    template <typename Format> void debug(Format&& format) const { log(LogLevel::Debug, std::forward<Format>(format)); }
+    template <typename Format> void info(Format&& format) const { log(LogLevel::Info, std::forward<Format>(format)); }
+    template <typename Format> void warning(Format&& format) const { log(LogLevel::Warning, std::forward<Format>(format)); }
+    template <typename Format> void error(Format&& format) const { log(LogLevel::Error, std::forward<Format>(format)); }
+
+private:
+    std::shared_ptr<LogSink> m_sink;
+    LogLevel m_minLevel = LogLevel::Off;
+};
+
+namespace logging_detail {
+
+inline std::mutex& defaultLoggerMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+inline Logger& defaultLoggerStorage() {
+    static Logger logger;
+    return logger;
+}
+
+} // namespace logging_detail
+
+/**
+ * @brief Returns the logger new carvers start with (silent unless set).
+ */
+inline Logger defaultLogger() {
+    std::lock_guard<std::mutex> lock(logging_detail::defaultLoggerMutex());
+    return logging_detail::defaultLoggerStorage();
+}
+
+/**
+ * @brief Replaces the logger new carvers start with.
+ */
+inline void setDefaultLogger(const Logger& logger) {
+    std::lock_guard<std::mutex> lock(logging_detail::defaultLoggerMutex());
+    logging_detail::defaultLoggerStorage() = logger;
+}
@@ -0,0 +1,56 @@
+/**
+ * @file pixel_types.hpp
+ * @author Utkarsh Sachan
+ * @brief Pixel-type dispatch shared by the carving routines.
+ *
+ * The carving loops are templates over the pixel type (uchar, ushort,
+ * cv::Vec3b, cv::Vec3w, cv::Vec4b, cv::Vec4w). `dispatchPixelType` maps an
+ * OpenCV matrix type to the matching instantiation once per call, so the
+ * loops run natively on the decoded data without a conversion pass.
+ */
+
+#pragma once
+
+#include <stdexcept>
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief Invokes `fn(Pixel())` with the element type matching an OpenCV matrix type.
+ *
+ * Supported types are 8-bit and 16-bit unsigned images with 1 (grayscale),
+ * 3 (BGR) or 4 (BGRA) channels.
+ * @throws std::runtime_error for any other type.
+ */
+template <typename Fn>
+void dispatchPixelType(int type, Fn&& fn) {
+    switch (type) {
+        case CV_8UC1: fn(uchar()); break;
+        case CV_8UC3: fn(cv::Vec3b()); break;
+        case CV_8UC4: fn(cv::Vec4b()); break;
+        case CV_16UC1: fn(ushort()); break;
+        case CV_16UC3: fn(cv::Vec3w()); break;
+        case CV_16UC4: fn(cv::Vec4w()); break;
+        default:
+            throw std::runtime_error("Unsupported image type: expected 8-bit or 16-bit with 1, 3 or 4 channels.");
+    }
+}
+
+/**
+ * @brief Averages two single-channel pixels.
+ */
+template <typename T>
+T averagePixel(T a, T b) {
+    return static_cast<T>((static_cast<int>(a) + static_cast<int>(b)) / 2);
+}
+
+/**
+ * @brief Averages two multi-channel pixels channel by channel.
+ */
+template <typename T, int N>
+cv::Vec<T, N> averagePixel(const cv::Vec<T, N>& a, const cv::Vec<T, N>& b) {
+    cv::Vec<T, N> result;
+    for (int k = 0; k < N; ++k) {
+        result[k] = averagePixel(a[k], b[k]);
+    }
+    return result;
+}
@@ -0,0 +1,185 @@
+/**
+ * @file raw_image.cpp
+ * @author Utkarsh Sachan
+ * @brief Implementation of the memory-mapped raw working format (see raw_image.hpp).
+ */
+
+#include "raw_image.hpp"
+#include "pixel_types.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+uint64_t roundUpToPage(uint64_t bytes) {
+    return (bytes + RAW_PAGE_BYTES - 1) / RAW_PAGE_BYTES * RAW_PAGE_BYTES;
+}
+
+std::string systemError(const std::string& what, const std::string& path) {
+    return what + " " + path + ": " + std::strerror(errno);
+}
+
+/**
+ * @brief True if a header read from disk describes an image the carver can
+ * map: positive dimensions, a supported pixel type and a size that fits in
+ * 64 bits. Checked before any size arithmetic trusts the fields.
+ */
+bool isValidHeader(const RawImageHeader& header) {
+    if (header.width <= 0 || header.height <= 0) {
+        return false;
+    }
+    try {
+        dispatchPixelType(header.type, [](auto) {});
+    } catch (const std::runtime_error&) {
+        return false;
+    }
+    const uint64_t maxBytes = std::numeric_limits<uint64_t>::max();
+    return header.dataOffset <= maxBytes && header.stride <= (maxBytes - header.dataOffset) / static_cast<uint64_t>(header.height);
+}
+
+} // namespace
+
+// ---
+// MappedImage
+// ---
+
+MappedImage::MappedImage(const std::string& path, bool writable) {
+    m_fd = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+    if (m_fd < 0) {
+        throw std::runtime_error(systemError("Could not open raw image", path));
+    }
+    if (::pread(m_fd, &m_header, sizeof(m_header), 0) != static_cast<ssize_t>(sizeof(m_header)) ||
+        m_header.magic != RAW_IMAGE_MAGIC || m_header.version != RAW_IMAGE_VERSION) {
+        ::close(m_fd);
+        throw std::runtime_error("Not a raw image (or unsupported version): " + path);
+    }
+    if (!isValidHeader(m_header)) {
+        ::close(m_fd);
+        throw std::runtime_error("Raw image has invalid dimensions or pixel type: " + path);
+    }
+    map(path, writable);
+}
+
+MappedImage MappedImage::create(const std::string& path, int width, int height, int type) {
+    if (width <= 0 || height <= 0) {
+        throw std::invalid_argument("Raw image dimensions must be positive.");
+    }
+    MappedImage image;
+    image.m_header.width = width;
+    image.m_header.height = height;
+    image.m_header.type = type;
+    image.m_header.stride = roundUpToPage(static_cast<uint64_t>(width) * CV_ELEM_SIZE(type));
+    image.m_header.dataOffset = roundUpToPage(sizeof(RawImageHeader));
+
+    image.m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (image.m_fd < 0) {
+        throw std::runtime_error(systemError("Could not create raw image", path));
+    }
+    // Extending with ftruncate leaves the pixel area sparse until written.
+    off_t fileBytes = static_cast<off_t>(image.m_header.dataOffset + image.m_header.stride * height);
+    if (::pwrite(image.m_fd, &image.m_header, sizeof(image.m_header), 0) != static_cast<ssize_t>(sizeof(image.m_header)) ||
+        ::ftruncate(image.m_fd, fileBytes) < 0) {
+        std::string error = systemError("Could not write raw image", path);
+        ::close(image.m_fd);
+        image.m_fd = -1;
+        throw std::runtime_error(error);
+    }
+    image.map(path, true);
+    return image;
+}
+
+void MappedImage::map(const std::string& path, bool writable) {
+    struct stat info;
+    m_size = static_cast<size_t>(m_header.dataOffset + m_header.stride * static_cast<uint64_t>(m_header.height));
+    if (::fstat(m_fd, &info) < 0 || static_cast<uint64_t>(info.st_size) < m_size ||
+        m_header.stride < static_cast<uint64_t>(m_header.width) * CV_ELEM_SIZE(m_header.type)) {
+        ::close(m_fd);
+        m_fd = -1;
+        throw std::runtime_error("Raw image is truncated or inconsistent: " + path);
+    }
+    m_data = ::mmap(nullptr, m_size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, m_fd, 0);
+    if (m_data == MAP_FAILED) {
+        std::string error = systemError("Could not map raw image", path);
+        ::close(m_fd);
+        m_fd = -1;
+        m_data = nullptr;
+        throw std::runtime_error(error);
+    }
+    // Carving sweeps rows in order; let the kernel read ahead.
+    ::madvise(m_data, m_size, MADV_SEQUENTIAL);
+}
+
+MappedImage::~MappedImage() {
+    if (m_data != nullptr) ::munmap(m_data, m_size);
+    if (m_fd >= 0) ::close(m_fd);
+}
+
+MappedImage::MappedImage(MappedImage&& other) noexcept
+    : m_fd(other.m_fd), m_data(other.m_data), m_size(other.m_size), m_header(other.m_header) {
+    other.m_fd = -1;
+    other.m_data = nullptr;
+    other.m_size = 0;
+}
+
+cv::Mat MappedImage::mat() const {
+    return cv::Mat(m_header.height, m_header.width, m_header.type,
+                   static_cast<unsigned char*>(m_data) + m_header.dataOffset, static_cast<size_t>(m_header.stride));
+}
+
+void MappedImage::shrinkTo(int width, int height) {
+    if (width <= 0 || height <= 0 || width > m_header.width || height > m_header.height) {
+        throw std::invalid_argument("A raw image can only shrink to a non-empty sub-image.");
+    }
+    RawImageHeader header = m_header;
+    header.width = width;
+    header.height = height;
+    if (::pwrite(m_fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+        throw std::runtime_error(std::string("Could not update raw image header: ") + std::strerror(errno));
+    }
+    m_header = header;
+}
+
+void MappedImage::flush() {
+    if (m_data != nullptr && ::msync(m_data, m_size, MS_SYNC) < 0) {
+        throw std::runtime_error(std::string("Could not flush raw image: ") + std::strerror(errno));
+    }
+}
+
+// ---
+// Conversion
+// ---
+
+bool isRawImagePath(const std::string& path) {
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) {
+        return false;
+    }
+    std::string ext = path.substr(dot + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char ch) { return std::tolower(ch); });
+    return ext == "scraw";
+}
+
+void writeRawImage(const cv::Mat& image, const std::string& path) {
+    MappedImage raw = MappedImage::create(path, image.cols, image.rows, image.type());
+    cv::Mat pixels = raw.mat();
+    image.copyTo(pixels);
+    raw.flush();
+}
+
+void convertToRawImage(const std::string& inputPath, const std::string& rawPath) {
+    cv::Mat image = cv::imread(inputPath, cv::IMREAD_UNCHANGED);
+    if (image.empty()) {
+        throw std::runtime_error("Could not load input image: " + inputPath);
+    }
+    writeRawImage(image, rawPath);
+}
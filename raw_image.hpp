@@ -0,0 +1,112 @@
+/**
+ * @file raw_image.hpp
+ * @author Utkarsh Sachan
+ * @brief Memory-mapped raw working format for images too large for RAM (POSIX only).
+ *
+ * A `.scraw` file is a 4 KiB header page followed by uncompressed pixel rows,
+ * each padded to a whole number of pages. Mapping it yields a plain strided
+ * cv::Mat, so the carver works on it directly (see
+ * SeamCarver::setCarveInPlace()); a band of rows is a band of pages, and the
+ * OS pages image data in and out as the carving loops sweep over it.
+ *
+ * Header layout (native endianness, the file is a local working copy):
+ *
+ *   RawImageHeader, zero padding to RAW_PAGE_BYTES, rows of `stride` bytes
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <opencv2/opencv.hpp>
+
+const uint32_t RAW_IMAGE_MAGIC = 0x57524353; // "SCRW"
+const uint32_t RAW_IMAGE_VERSION = 1;
+const uint64_t RAW_PAGE_BYTES = 4096;
+
+/**
+ * @brief The fixed header at the start of a `.scraw` file.
+ */
+struct RawImageHeader {
+    uint32_t magic = RAW_IMAGE_MAGIC;
+    uint32_t version = RAW_IMAGE_VERSION;
+    int32_t width = 0;
+    int32_t height = 0;
+    int32_t type = 0;        ///< OpenCV type (CV_8UC3, CV_16UC4, ...).
+    int32_t reserved = 0;
+    uint64_t stride = 0;     ///< Bytes per row, a multiple of RAW_PAGE_BYTES.
+    uint64_t dataOffset = 0; ///< Offset of the first row, a multiple of RAW_PAGE_BYTES.
+};
+
+/**
+ * @class MappedImage
+ * @brief A `.scraw` file mapped into memory (shared, so writes reach the file).
+ */
+class MappedImage {
+public:
+    /**
+     * @brief Maps an existing raw file.
+     * @param writable Map read-write (required for carving in place).
+     * @throws std::runtime_error if the file is missing or not a valid raw image.
+     */
+    explicit MappedImage(const std::string& path, bool writable = true);
+
+    /**
+     * @brief Creates (or truncates) a raw file of the given size and type and maps it.
+     * @throws std::runtime_error if the file cannot be created.
+     */
+    static MappedImage create(const std::string& path, int width, int height, int type);
+
+    ~MappedImage();
+    MappedImage(MappedImage&& other) noexcept;
+    MappedImage& operator=(MappedImage&&) = delete;
+    MappedImage(const MappedImage&) = delete;
+    MappedImage& operator=(const MappedImage&) = delete;
+
+    /**
+     * @brief The pixels as a matrix header over the mapping (no copy).
+     * Valid while this object lives.
+     */
+    cv::Mat mat() const;
+
+    /**
+     * @brief Rewrites the header to describe the top-left width x height
+     * sub-image, e.g. after carving in place. Rows keep their stride, so the
+     * file stays valid; the pixels are not moved. Requires a writable mapping.
+     * @throws std::invalid_argument if the size is empty or larger than the image.
+     * @throws std::runtime_error if the header cannot be written.
+     */
+    void shrinkTo(int width, int height);
+
+    /**
+     * @brief Writes dirty pages back to the file.
+     */
+    void flush();
+
+private:
+    MappedImage() = default;
+    void map(const std::string& path, bool writable);
+
+    int m_fd = -1;
+    void* m_data = nullptr;
+    size_t m_size = 0;
+    RawImageHeader m_header;
+};
+
+/**
+ * @brief True if the path has the `.scraw` extension.
+ */
+bool isRawImagePath(const std::string& path);
+
+/**
+ * @brief Writes an image (any size, supported type) as a `.scraw` file.
+ * @throws std::runtime_error if the file cannot be written.
+ */
+void writeRawImage(const cv::Mat& image, const std::string& path);
+
+/**
+ * @brief Decodes a common format (JPEG, PNG, TIFF, ...) into a `.scraw` file.
+ * The source is decoded in memory once; every later run maps the result.
+ * @throws std::runtime_error if the input cannot be decoded or the output written.
+ */
+void convertToRawImage(const std::string& inputPath, const std::string& rawPath);
@@ -7,11 +7,19 @@
  * both seam removal (shrinking) and seam insertion (expanding) for width and height.
  *
  * It also includes advanced features:
- * 1. Sobel Energy Function: Uses Sobel gradients for robust energy calculation.
+ * 1. Pluggable Energy Functions: Sobel (3x3/5x5), Scharr, dual-gradient, per-channel
+ * RGB gradient, entropy and saliency-weighted energy, selected via `--energy` and
+ * dispatched once per resize to fully specialized carving loops (see energy.hpp).
  * 2. Protection Masking: Allows a user to provide a mask to protect areas
  * (e.g., faces) from being carved. Protected pixels are given max energy.
  * 3. Removal Masking: Allows a user to provide a mask to target areas
  * (e.g., an object) for removal. Targeted pixels are given min energy.
+ * 4. Native Pixel Formats: Grayscale, BGR and BGRA images at 8 or 16 bits per
+ * channel are carved directly (no conversion to 8-bit BGR, alpha preserved).
+ *
+ * This file is the command-line front end. The algorithm itself lives in
+ * libseamcarver (seam_carver.hpp / seam_carver_lib.cpp), which can also be
+ * embedded in-process from C++ (cv::Mat or raw buffers) or C (seam_carver_c.h).
  *
  * This project uses modern C++ practices:
  * - Encapsulated in a `SeamCarver` class.
@@ -23,7 +31,7 @@
  * ---
  *
  * Build Command:
- * g++ -std=c++17 -o seam_carver seam_carver.cpp `pkg-config --cflags --libs opencv4`
+ * g++ -std=c++17 -O2 -o seam_carver seam_carver.cpp seam_carver_lib.cpp batch.cpp daemon.cpp video.cpp raw_image.cpp seam_file.cpp face_detect.cpp vector_mask.cpp -pthread `pkg-config --cflags --libs opencv4`
  *
  * ---
  *
@@ -38,464 +46,158 @@
  * 3. Shrink, but protect a face:
  * ./seam_carver -i=face.jpg -o=shrunk.jpg -w=400 --protect=face_mask.png
  *
+ *    or detect faces in-process instead of preparing a mask:
+ * ./seam_carver -i=face.jpg -o=shrunk.jpg -w=400 --auto-protect=faces
+ *    or give rectangles and polygons instead of a mask image (see vector_mask.hpp):
+ * ./seam_carver -i=face.jpg -o=shrunk.jpg -w=400 --shapes=regions.json
+ *
  * 4. Remove an object from a scene:
  * ./seam_carver -i=scene.jpg -o=removed.jpg -w=500 --remove=object_mask.png
+ *    or let it stop when the object is gone, then restore the original size:
+ * ./seam_carver -i=scene.jpg -o=removed.jpg --remove=object_mask.png --remove-object=restore
+ *
+ * 5. Use the cheaper dual-gradient energy:
+ * ./seam_carver -i=input.jpg -o=output.jpg -w=500 --energy=dual
+ *
+ * 6. Process a whole manifest on 16 threads (see batch.hpp for the format):
+ * ./seam_carver --batch=jobs.csv --jobs=16
+ *
+ * 7. Report per-phase timing and counters as JSON:
+ * ./seam_carver -i=input.jpg -o=output.jpg -w=500 --stats=stats.json
+ *
+ * 8. Finish within ~200 ms, trading quality for speed if needed:
+ * ./seam_carver -i=large.jpg -o=output.jpg -w=1200 --budget=200
+ *
+ * 9. Shrink a large photo hard: carve part of the way, area-scale the rest:
+ * ./seam_carver -i=large.jpg -o=thumb.jpg -w=300 -h=300 --hybrid
+ *
+ * 10. Retarget a video with seams that stay coherent between frames:
+ * ./seam_carver -i=clip.mp4 -o=clip_narrow.mp4 -w=480 --video
+ *
+ * 11. Carve a scan too large for RAM: convert it once, then carve the mapped copy in place:
+ * ./seam_carver -i=scan.tif -o=scan.scraw
+ * ./seam_carver -i=scan.scraw -o=narrow.tif -w=40000
+ *
+ * 12. Record the seams of a carve, then apply the same carve to another rendition:
+ * ./seam_carver -i=preview.jpg -o=preview_narrow.jpg -w=500 --save-seams=carve.seams
+ * ./seam_carver -i=master.tif -o=master_narrow.tif --apply-seams=carve.seams
+ *
+ * 13. Shrink a large photo fast: search seams on a 1/4 proxy, remove them at full resolution:
+ * ./seam_carver -i=large.jpg -o=output.jpg -w=2000 --proxy=4
+ *
+ * 14. Keep a resident daemon warm, then send it jobs (see daemon.hpp):
+ * ./seam_carver --daemon=/tmp/seam_carver.sock --jobs=8
+ * ./seam_carver -i=input.jpg -o=output.jpg -w=500 --connect=/tmp/seam_carver.sock
  *
  */
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
 #include <iostream>
-#include <vector>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
 #include <string>
-#include <limits>
+#include <vector>
 #include <opencv2/opencv.hpp>
 
-// Use high-precision constants for energy modification
-const double MAX_ENERGY = 1e9;
-const double MIN_ENERGY = -1e9;
+#include "seam_carver.hpp"
+#include "batch.hpp"
+#include "daemon.hpp"
+#include "face_detect.hpp"
+#include "image_probe.hpp"
+#include "raw_image.hpp"
+#include "seam_file.hpp"
+#include "vector_mask.hpp"
+#include "video.hpp"
+
+// ---
+// Daemon client helpers
+// ---
 
 /**
- * @class SeamCarver
- * @brief Encapsulates all logic and data for the seam carving algorithm.
+ * @brief Reads a whole file without decoding it (empty path = empty buffer).
  */
-class SeamCarver {
-public:
-    /**
-     * @brief Loads the image and optional masks.
-     * @param imagePath Path to the input image.
-     * @param protectMaskPath Path to the (optional) protection mask.
-     * @param removeMaskPath Path to the (optional) removal mask.
-     */
-    SeamCarver(const std::string& imagePath, const std::string& protectMaskPath, const std::string& removeMaskPath) {
-        m_image = cv::imread(imagePath);
-        if (m_image.empty()) {
-            throw std::runtime_error("Could not load input image: " + imagePath);
-        }
-
-        // Load optional masks
-        if (!protectMaskPath.empty()) {
-            m_protectionMask = cv::imread(protectMaskPath, cv::IMREAD_GRAYSCALE);
-            if (m_protectionMask.empty()) {
-                std::cerr << "Warning: Could not load protection mask: " << protectMaskPath << std::endl;
-            } else if (m_protectionMask.size() != m_image.size()) {
-                std::cerr << "Warning: Protection mask dimensions do not match image. Resizing mask." << std::endl;
-                cv::resize(m_protectionMask, m_protectionMask, m_image.size());
-            }
-        }
-
-        if (!removeMaskPath.empty()) {
-            m_removalMask = cv::imread(removeMaskPath, cv::IMREAD_GRAYSCALE);
-            if (m_removalMask.empty()) {
-                std::cerr << "Warning: Could not load removal mask: " << removeMaskPath << std::endl;
-            } else if (m_removalMask.size() != m_image.size()) {
-                std::cerr << "Warning: Removal mask dimensions do not match image. Resizing mask." << std::endl;
-                cv::resize(m_removalMask, m_removalMask, m_image.size());
-            }
-        }
-
-        std::cout << "Image loaded: " << m_image.cols << "x" << m_image.rows << std::endl;
+static std::vector<unsigned char> readFileBytes(const std::string& path) {
+    if (path.empty()) {
+        return {};
     }
-
-    /**
-     * @brief Resizes the image to the target dimensions.
-     * @param newWidth The target width.
-     * @param newHeight The target height.
-     */
-    void resize(int newWidth, int newHeight) {
-        if (newWidth < 0 || newHeight < 0) {
-            throw std::invalid_argument("New dimensions must be non-negative.");
-        }
-
-        int currentWidth = m_image.cols;
-        int currentHeight = m_image.rows;
-
-        // --- 1. Width Resizing ---
-        int deltaCols = newWidth - currentWidth;
-        if (deltaCols < 0) {
-            std::cout << "Reducing width by " << -deltaCols << " pixels..." << std::endl;
-            for (int i = 0; i < -deltaCols; ++i) {
-                calculateEnergy();
-                std::vector<int> seam = findVerticalSeam();
-                removeVerticalSeam(seam);
-            }
-        } else if (deltaCols > 0) {
-            std::cout << "Expanding width by " << deltaCols << " pixels..." << std::endl;
-            // For expansion, we find all seams at once on the original image
-            // to avoid repeatedly adding seams in the same low-energy area.
-            cv::Mat originalImage = m_image.clone();
-            std::vector<std::vector<int>> seams;
-            for (int i = 0; i < deltaCols; ++i) {
-                calculateEnergy();
-                std::vector<int> seam = findVerticalSeam();
-                seams.push_back(seam);
-                // Temporarily remove seam to find the *next* best seam
-                removeVerticalSeam(seam);
-            }
-            // Restore original image and add all found seams
-            m_image = originalImage;
-            addVerticalSeams(seams);
-        }
-
-        // --- 2. Height Resizing ---
-        int deltaRows = newHeight - currentHeight;
-        if (deltaRows < 0) {
-            std::cout << "Reducing height by " << -deltaRows << " pixels..." << std::endl;
-            for (int i = 0; i < -deltaRows; ++i) {
-                calculateEnergy();
-                std::vector<int> seam = findHorizontalSeam();
-                removeHorizontalSeam(seam);
-            }
-        } else if (deltaRows > 0) {
-            std::cout << "Expanding height by " << deltaRows << " pixels..." << std::endl;
-            cv::Mat originalImage = m_image.clone();
-            std::vector<std::vector<int>> seams;
-            for (int i = 0; i < deltaRows; ++i) {
-                calculateEnergy();
-                std::vector<int> seam = findHorizontalSeam();
-                seams.push_back(seam);
-                removeHorizontalSeam(seam);
-            }
-            m_image = originalImage;
-            addHorizontalSeams(seams);
-        }
-
-        std::cout << "Resize complete. New dimensions: " << m_image.cols << "x" << m_image.rows << std::endl;
-    }
-
-    /**
-     * @brief Saves the processed image to a file.
-     * @param outputPath Path to save the new image.
-     */
-    void saveImage(const std::string& outputPath) {
-        if (!cv::imwrite(outputPath, m_image)) {
-            throw std::runtime_error("Failed to save image to: " + outputPath);
-        }
-        std::cout << "Image saved successfully to: " << outputPath << std::endl;
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Could not open file: " + path);
     }
+    return std::vector<unsigned char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
 
-    /**
-     * @brief Displays the current image in a window.
-     * @param windowName The name for the display window.
-     */
-    void showImage(const std::string& windowName) {
-        cv::imshow(windowName, m_image);
-        std::cout << "Press any key to close the image window..." << std::endl;
-        cv::waitKey(0);
-    }
-
-private:
-    cv::Mat m_image;
-    cv::Mat m_energyMap;
-    cv::Mat m_protectionMask;
-    cv::Mat m_removalMask;
-
-    /**
-     * @brief Calculates the energy map using Sobel filters and applies masks.
-     */
-    void calculateEnergy() {
-        cv::Mat gray, grad_x, grad_y, abs_grad_x, abs_grad_y;
-
-        // 1. Convert to grayscale
-        cv::cvtColor(m_image, gray, cv::COLOR_BGR2GRAY);
-
-        // 2. Apply Sobel filters with stronger kernel for better edge detection
-        cv::Sobel(gray, grad_x, CV_64F, 1, 0, 5);
-        cv::Sobel(gray, grad_y, CV_64F, 0, 1, 5);
-
-        // 3. Compute gradient magnitude: E = sqrt(grad_x^2 + grad_y^2)
-        cv::Mat grad_x_sq, grad_y_sq;
-        cv::multiply(grad_x, grad_x, grad_x_sq);
-        cv::multiply(grad_y, grad_y, grad_y_sq);
-        cv::sqrt(grad_x_sq + grad_y_sq, m_energyMap);
-
-        // Normalize to 0-255 range for better contrast
-        cv::normalize(m_energyMap, m_energyMap, 0, 255, cv::NORM_MINMAX);
-
-        // 4. Apply masks
-        if (!m_protectionMask.empty()) {
-            for (int r = 0; r < m_image.rows; ++r) {
-                for (int c = 0; c < m_image.cols; ++c) {
-                    // If mask pixel is non-zero (white), apply max energy
-                    if (m_protectionMask.at<uchar>(r, c) > 0) {
-                        m_energyMap.at<double>(r, c) = MAX_ENERGY;
-                    }
-                }
-            }
-        }
-        
-        if (!m_removalMask.empty()) {
-            for (int r = 0; r < m_image.rows; ++r) {
-                for (int c = 0; c < m_image.cols; ++c) {
-                    // If mask pixel is non-zero (white), apply min energy
-                    if (m_removalMask.at<uchar>(r, c) > 0) {
-                        m_energyMap.at<double>(r, c) = MIN_ENERGY;
-                    }
-                }
-            }
-        }
-    }
-
-    /**
-     * @brief Finds the lowest-energy vertical seam using dynamic programming.
-     * @return A vector of column indices, one for each row.
-     */
-    std::vector<int> findVerticalSeam() {
-        int rows = m_image.rows;
-        int cols = m_image.cols;
-        std::vector<int> seam(rows);
-
-        // DP cost matrix
-        cv::Mat dpCost = cv::Mat(rows, cols, CV_64F);
-
-        // Parent pointers to reconstruct the path
-        cv::Mat parent = cv::Mat(rows, cols, CV_32S);
-
-        // 1. Initialize first row
-        m_energyMap.row(0).copyTo(dpCost.row(0));
-
-        // 2. Fill DP table
-        for (int r = 1; r < rows; ++r) {
-            for (int c = 0; c < cols; ++c) {
-                double left = (c > 0) ? dpCost.at<double>(r - 1, c - 1) : std::numeric_limits<double>::max();
-                double middle = dpCost.at<double>(r - 1, c);
-                double right = (c < cols - 1) ? dpCost.at<double>(r - 1, c + 1) : std::numeric_limits<double>::max();
-
-                double minVal = middle;
-                int minIdx = c;
-
-                if (left < minVal) {
-                    minVal = left;
-                    minIdx = c - 1;
-                }
-                if (right < minVal) {
-                    minVal = right;
-                    minIdx = c + 1;
-                }
-
-                dpCost.at<double>(r, c) = m_energyMap.at<double>(r, c) + minVal;
-                parent.at<int>(r, c) = minIdx;
-            }
-        }
-
-        // 3. Find minimum cost in the last row
-        double minVal = std::numeric_limits<double>::max();
-        int minIdx = 0;
-        for (int c = 0; c < cols; ++c) {
-            if (dpCost.at<double>(rows - 1, c) < minVal) {
-                minVal = dpCost.at<double>(rows - 1, c);
-                minIdx = c;
-            }
-        }
-
-        // 4. Backtrack to find the seam
-        seam[rows - 1] = minIdx;
-        for (int r = rows - 2; r >= 0; --r) {
-            seam[r] = parent.at<int>(r + 1, seam[r + 1]);
-        }
-
-        return seam;
+/**
+ * @brief Sends one encoded job to a running daemon and writes the encoded result.
+ * The input is forwarded as-is; the daemon decodes it and encodes the result
+ * in the output path's format.
+ */
+static int runDaemonClient(const std::string& socketPath, const std::string& inputPath, const std::string& outputPath,
+                           int targetWidth, int targetHeight, EnergyFunction energy,
+                           const std::string& protectPath, const std::string& removePath, int timeoutMs) {
+    DaemonJob job;
+    job.header.timeoutMilliseconds = static_cast<uint32_t>(std::max(0, timeoutMs));
+    job.header.targetWidth = targetWidth;
+    job.header.targetHeight = targetHeight;
+    job.header.energy = static_cast<int32_t>(energy);
+
+    size_t dot = outputPath.find_last_of('.');
+    std::string extension = (dot == std::string::npos) ? ".png" : outputPath.substr(dot);
+    if (extension.size() >= sizeof(job.header.outputExtension)) {
+        throw std::invalid_argument("Unsupported output extension: " + extension);
     }
+    std::memset(job.header.outputExtension, 0, sizeof(job.header.outputExtension));
+    std::memcpy(job.header.outputExtension, extension.data(), extension.size());
 
-    /**
-     * @brief Removes a vertical seam from the image.
-     * @param seam The seam to remove (vector of column indices).
-     */
-    void removeVerticalSeam(const std::vector<int>& seam) {
-        int rows = m_image.rows;
-        int cols = m_image.cols;
-
-        cv::Mat newImage(rows, cols - 1, m_image.type());
-
-        for (int r = 0; r < rows; ++r) {
-            int seamCol = seam[r];
-            for (int c = 0; c < cols - 1; ++c) {
-                if (c < seamCol) {
-                    newImage.at<cv::Vec3b>(r, c) = m_image.at<cv::Vec3b>(r, c);
-                } else {
-                    newImage.at<cv::Vec3b>(r, c) = m_image.at<cv::Vec3b>(r, c + 1);
-                }
-            }
-        }
-        m_image = newImage;
-
-        // Also update masks if they exist
-        if (!m_protectionMask.empty()) {
-            cv::Mat newMask(rows, cols - 1, m_protectionMask.type());
-            for (int r = 0; r < rows; ++r) {
-                int seamCol = seam[r];
-                for (int c = 0; c < cols - 1; ++c) {
-                    newMask.at<uchar>(r, c) = (c < seamCol) ? m_protectionMask.at<uchar>(r, c) : m_protectionMask.at<uchar>(r, c + 1);
-                }
-            }
-            m_protectionMask = newMask;
-        }
+    job.image = readFileBytes(inputPath);
+    job.protectMask = readFileBytes(protectPath);
+    job.removeMask = readFileBytes(removePath);
 
-        if (!m_removalMask.empty()) {
-            cv::Mat newMask(rows, cols - 1, m_removalMask.type());
-            for (int r = 0; r < rows; ++r) {
-                int seamCol = seam[r];
-                for (int c = 0; c < cols - 1; ++c) {
-                    newMask.at<uchar>(r, c) = (c < seamCol) ? m_removalMask.at<uchar>(r, c) : m_removalMask.at<uchar>(r, c + 1);
-                }
-            }
-            m_removalMask = newMask;
-        }
-    }
-
-    /**
-     * @brief Adds multiple vertical seams to the image.
-     * @param seams A vector of seams to add.
-     */
-    void addVerticalSeams(std::vector<std::vector<int>>& seams) {
-        int rows = m_image.rows;
-        int cols = m_image.cols;
-        int numSeams = seams.size();
-
-        cv::Mat newImage(rows, cols + numSeams, m_image.type());
-
-        for (int r = 0; r < rows; ++r) {
-            // Sort seam indices for this row to process them from left to right
-            std::vector<int> rowSeamIndices;
-            for(const auto& seam : seams) {
-                rowSeamIndices.push_back(seam[r]);
-            }
-            std::sort(rowSeamIndices.begin(), rowSeamIndices.end());
-
-            int newCol = 0;
-            int oldCol = 0;
-            int seamIdx = 0;
-
-            while (oldCol < cols) {
-                // Copy original pixel
-                newImage.at<cv::Vec3b>(r, newCol) = m_image.at<cv::Vec3b>(r, oldCol);
-
-                // If this is a seam pixel, add a new pixel
-                if (seamIdx < numSeams && oldCol == rowSeamIndices[seamIdx]) {
-                    newCol++;
-                    cv::Vec3b newPixel;
-                    if (oldCol < cols - 1) {
-                        // Average with right neighbor
-                        newPixel = (m_image.at<cv::Vec3b>(r, oldCol) / 2) + (m_image.at<cv::Vec3b>(r, oldCol + 1) / 2);
-                    } else {
-                        // At edge, just duplicate
-                        newPixel = m_image.at<cv::Vec3b>(r, oldCol);
-                    }
-                    newImage.at<cv::Vec3b>(r, newCol) = newPixel;
-                    seamIdx++;
-                }
-                newCol++;
-                oldCol++;
-            }
-        }
-        m_image = newImage;
-        // Note: We don't expand masks as the semantics are unclear.
-        // We assume expansion adds "neutral" content.
+    DaemonClient client(socketPath);
+    DaemonResult result = client.resize(job);
+    if (result.header.status != 0) {
+        std::cerr << "Daemon error: " << result.message << std::endl;
+        return -1;
     }
 
-    /**
-     * @brief Finds the lowest-energy horizontal seam.
-     * @return A vector of row indices, one for each column.
-     */
-    std::vector<int> findHorizontalSeam() {
-        // --- Transpose Method ---
-        // 1. Transpose the image and energy map
-        cv::Mat originalImage = m_image;
-        cv::Mat originalEnergy = m_energyMap;
-        cv::Mat originalProtect = m_protectionMask;
-        cv::Mat originalRemove = m_removalMask;
-
-        m_image = m_image.t();
-        m_energyMap = m_energyMap.t();
-        if(!m_protectionMask.empty()) m_protectionMask = m_protectionMask.t();
-        if(!m_removalMask.empty()) m_removalMask = m_removalMask.t();
-        
-        // 2. Find a *vertical* seam on the transposed data
-        std::vector<int> seam = findVerticalSeam();
-
-        // 3. Restore original (non-transposed) data
-        m_image = originalImage;
-        m_energyMap = originalEnergy;
-        m_protectionMask = originalProtect;
-        m_removalMask = originalRemove;
-
-        return seam;
+    std::ofstream file(outputPath, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(result.image.data()), static_cast<std::streamsize>(result.image.size()));
+    if (!file) {
+        throw std::runtime_error("Could not write image to: " + outputPath);
     }
+    std::cout << "Image saved to: " << outputPath << " (" << result.header.width << "x" << result.header.height << ")" << std::endl;
+    return 0;
+}
 
-    /**
-     * @brief Removes a horizontal seam from the image.
-     * @param seam The seam to remove (vector of row indices).
-     */
-    void removeHorizontalSeam(const std::vector<int>& seam) {
-        int rows = m_image.rows;
-        int cols = m_image.cols;
-
-        cv::Mat newImage(rows - 1, cols, m_image.type());
-
-        for (int c = 0; c < cols; ++c) {
-            int seamRow = seam[c];
-            for (int r = 0; r < rows - 1; ++r) {
-                if (r < seamRow) {
-                    newImage.at<cv::Vec3b>(r, c) = m_image.at<cv::Vec3b>(r, c);
-                } else {
-                    newImage.at<cv::Vec3b>(r, c) = m_image.at<cv::Vec3b>(r + 1, c);
-                }
-            }
-        }
-        m_image = newImage;
-
-        // Also update masks if they exist
-        if (!m_protectionMask.empty()) {
-            cv::Mat newMask(rows - 1, cols, m_protectionMask.type());
-            for (int c = 0; c < cols; ++c) {
-                int seamRow = seam[c];
-                for (int r = 0; r < rows - 1; ++r) {
-                    newMask.at<uchar>(r, c) = (r < seamRow) ? m_protectionMask.at<uchar>(r, c) : m_protectionMask.at<uchar>(r + 1, c);
-                }
-            }
-            m_protectionMask = newMask;
-        }
+// ---
+// Raw working file helpers
+// ---
 
-        if (!m_removalMask.empty()) {
-            cv::Mat newMask(rows - 1, cols, m_removalMask.type());
-            for (int c = 0; c < cols; ++c) {
-                int seamRow = seam[c];
-                for (int r = 0; r < rows - 1; ++r) {
-                    newMask.at<uchar>(r, c) = (r < seamRow) ? m_removalMask.at<uchar>(r, c) : m_removalMask.at<uchar>(r + 1, c);
-                }
-            }
-            m_removalMask = newMask;
-        }
+/**
+ * @brief Makes a raw file carved in place describe the carver's current image.
+ *
+ * Called whether the carve finished or stopped early: the removals already
+ * shifted the mapped pixels, so the old header would describe garbage. The
+ * image normally is the top-left corner of the mapping (same stride); scaling
+ * allocates, so a scaled result is copied back first. Then the header shrinks
+ * to the carved size and everything is synced to disk.
+ */
+static void commitInPlaceCarve(MappedImage& mapped, const cv::Mat& image) {
+    cv::Mat pixels = mapped.mat();
+    if (image.cols > pixels.cols || image.rows > pixels.rows) {
+        throw std::logic_error("An in-place carve grew the raw image.");
     }
-
-    /**
-     * @brief Adds multiple horizontal seams to the image.
-     * @param seams A vector of seams to add.
-     */
-    void addHorizontalSeams(std::vector<std::vector<int>>& seams) {
-        // --- Transpose Method ---
-        // 1. Transpose the image
-        m_image = m_image.t();
-
-        // 2. Transpose the seams
-        // (This is tricky. We need to convert horizontal seams to vertical seams on the transposed image)
-        int rows = m_image.rows; // Original cols
-        int cols = m_image.cols; // Original rows
-        int numSeams = seams.size();
-        
-        std::vector<std::vector<int>> transposedSeams(numSeams, std::vector<int>(rows));
-        for(int i = 0; i < numSeams; ++i) {
-            for(int j = 0; j < rows; ++j) {
-                transposedSeams[i][j] = seams[i][j];
-            }
-        }
-
-        // 3. Call the *vertical* add function
-        addVerticalSeams(transposedSeams);
-
-        // 4. Transpose the result back
-        m_image = m_image.t();
+    cv::Mat corner = pixels(cv::Rect(0, 0, image.cols, image.rows));
+    if (image.data != corner.data || image.step != corner.step) {
+        image.copyTo(corner);
     }
-};
-
+    mapped.shrinkTo(image.cols, image.rows);
+    mapped.flush();
+}
 
 // ---
 // Main function: Handles Command-Line Interface (CLI)
@@ -508,7 +210,28 @@ const char* keys =
     "{ height h       | -1 | target height (default: original height) }"
     "{ protect p      |   | (optional) path to protection mask }"
     "{ remove r       |   | (optional) path to removal mask }"
-    "{ show s         |   | (optional) show final image in a window }";
+    "{ shapes         |   | (optional) JSON list of rectangles and polygons to protect or remove (see vector_mask.hpp) }"
+    "{ auto-protect   |   | (optional) detect regions to protect in-process; supported: faces }"
+    "{ cascade        |   | (optional) Haar cascade for --auto-protect=faces (default: search the OpenCV install) }"
+    "{ min-face       | 0.04 | smallest face for --auto-protect=faces, as a share of the image's shorter side }"
+    "{ show s         |   | (optional) show final image in a window }"
+    "{ energy e       | sobel5 | energy function: sobel3, sobel5, scharr, dual, rgb, entropy, saliency }"
+    "{ batch b        |   | (optional) path to a batch manifest (input,output[,width[,height[,protect[,remove]]]]) }"
+    "{ validate       |   | (optional) with --batch: check the manifest from file headers only, without carving }"
+    "{ jobs j         | 0  | worker threads for batch, video and daemon mode (default: all cores) }"
+    "{ budget         | 0  | (optional) time budget in ms; trades quality for speed to meet it (0 = exact) }"
+    "{ remove-object  |   | (optional) carve away the --remove object, ignoring -w/-h (=restore re-expands to the original size) }"
+    "{ full-decode    |   | (optional) never decode JPEGs at reduced resolution for large downscales }"
+    "{ proxy          | 1  | (optional) search reduction seams on a proxy downscaled by this factor (1 = off) }"
+    "{ hybrid         |   | (optional) carve part of a reduction and scale the rest (bare = automatic, or a carve fraction 0-1) }"
+    "{ timeout        | 0  | (optional) abandon the resize after this many milliseconds (0 = no limit) }"
+    "{ log            |   | log level: debug, info, warning, error, off (default: info; warning in batch/daemon mode) }"
+    "{ stats          |   | (optional) print per-phase timing and counters as JSON (or --stats=<file>) }"
+    "{ save-seams     |   | (optional) write the seams of the carve to this file (see seam_file.hpp) }"
+    "{ apply-seams    |   | (optional) replay a saved carve instead of searching seams; ignores -w/-h }"
+    "{ video          |   | (optional) treat input and output as video files; seams stay coherent between frames }"
+    "{ daemon         |   | (optional) run as a resident daemon listening on this Unix socket path }"
+    "{ connect        |   | (optional) send the job to a daemon listening on this Unix socket path }";
 
 int main(int argc, char* argv[]) {
     cv::CommandLineParser parser(argc, argv, keys);
@@ -525,7 +248,100 @@ int main(int argc, char* argv[]) {
     int targetHeight = parser.get<int>("height");
     std::string protectPath = parser.get<std::string>("protect");
     std::string removePath = parser.get<std::string>("remove");
+    std::string shapesPath = parser.get<std::string>("shapes");
     bool showResult = parser.has("show");
+    std::string energyName = parser.get<std::string>("energy");
+    std::string batchPath = parser.get<std::string>("batch");
+    std::string daemonPath = parser.get<std::string>("daemon");
+    std::string connectPath = parser.get<std::string>("connect");
+    bool printStats = parser.has("stats");
+    std::string statsPath = printStats ? parser.get<std::string>("stats") : "";
+    if (statsPath == "true") {
+        statsPath.clear(); // bare --stats
+    }
+    int timeoutMs = parser.get<int>("timeout");
+    int budgetMs = parser.get<int>("budget");
+    bool removeObject = parser.has("remove-object");
+    bool restoreSize = removeObject && parser.get<std::string>("remove-object") == "restore";
+    HybridOptions hybrid;
+    hybrid.enabled = parser.has("hybrid");
+    std::string hybridFraction = hybrid.enabled ? parser.get<std::string>("hybrid") : "";
+    std::string autoProtect = parser.get<std::string>("auto-protect");
+    std::string cascadePath = parser.get<std::string>("cascade");
+    FaceDetectionOptions faceOptions;
+    faceOptions.minFaceFraction = parser.get<double>("min-face");
+    if (!autoProtect.empty() && autoProtect != "faces") {
+        std::cerr << "Error: Unsupported --auto-protect target: " << autoProtect << " (expected faces)" << std::endl;
+        return -1;
+    }
+    std::string saveSeamsPath = parser.get<std::string>("save-seams");
+    std::string applySeamsPath = parser.get<std::string>("apply-seams");
+    std::string logLevel = parser.get<std::string>("log");
+    bool serviceMode = !batchPath.empty() || !daemonPath.empty();
+
+    // The library is silent by default. Interactive runs log progress messages;
+    // batch and daemon runs only log problems, written off the worker threads.
+    // Option values that need parsing are checked here too, before any work.
+    try {
+        LogLevel level = logLevel.empty() ? (serviceMode ? LogLevel::Warning : LogLevel::Info) : parseLogLevel(logLevel);
+        std::shared_ptr<LogSink> sink = std::make_shared<StreamLogSink>();
+        if (serviceMode) {
+            sink = std::make_shared<AsyncLogSink>(sink);
+        }
+        setDefaultLogger(Logger(sink, level));
+
+        // A bare --hybrid reads as "true" and picks the fraction automatically.
+        if (hybrid.enabled && hybridFraction != "true") {
+            size_t parsed = 0;
+            try {
+                hybrid.carveFraction = std::stod(hybridFraction, &parsed);
+            } catch (const std::invalid_argument&) {
+                parsed = 0;
+            } catch (const std::out_of_range&) {
+                parsed = 0;
+            }
+            if (parsed == 0 || parsed != hybridFraction.size() || !(hybrid.carveFraction >= 0.0 && hybrid.carveFraction <= 1.0)) {
+                throw std::invalid_argument("Unsupported --hybrid fraction: " + hybridFraction + " (expected 0-1)");
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "An error occurred: " << e.what() << std::endl;
+        return -1;
+    }
+
+    // Daemon mode: serve jobs until interrupted
+    if (!daemonPath.empty()) {
+        try {
+            DaemonOptions options;
+            options.socketPath = daemonPath;
+            options.jobs = parser.get<int>("jobs");
+            return runDaemon(options);
+        } catch (const std::exception& e) {
+            std::cerr << "An error occurred: " << e.what() << std::endl;
+            return -1;
+        }
+    }
+
+    // Batch mode: every job comes from the manifest
+    if (!batchPath.empty()) {
+        try {
+            BatchOptions options;
+            options.jobs = parser.get<int>("jobs");
+            options.energy = parseEnergyFunction(energyName);
+            options.stats = printStats;
+            options.protectFaces = !autoProtect.empty();
+            options.cascadePath = cascadePath;
+            options.faceDetection = faceOptions;
+            std::vector<BatchEntry> entries = readManifest(batchPath);
+            if (parser.has("validate")) {
+                return validateManifest(entries, options.jobs) == 0 ? 0 : -1;
+            }
+            return runBatch(entries, options) == 0 ? 0 : -1;
+        } catch (const std::exception& e) {
+            std::cerr << "An error occurred: " << e.what() << std::endl;
+            return -1;
+        }
+    }
 
     if (inputPath.empty() || outputPath.empty()) {
         std::cerr << "Error: Input and Output paths are required." << std::endl;
@@ -533,27 +349,197 @@ int main(int argc, char* argv[]) {
         return -1;
     }
 
+    // Video mode: every frame of the clip, warm-started from the previous one
+    if (parser.has("video")) {
+        try {
+            VideoOptions options;
+            options.width = targetWidth;
+            options.height = targetHeight;
+            options.energy = parseEnergyFunction(energyName);
+            options.jobs = parser.get<int>("jobs");
+            return runVideo(inputPath, outputPath, options) > 0 ? 0 : -1;
+        } catch (const std::exception& e) {
+            std::cerr << "An error occurred: " << e.what() << std::endl;
+            return -1;
+        }
+    }
+
+    // Client mode: the daemon does the decoding, carving and encoding
+    if (!connectPath.empty()) {
+        try {
+            return runDaemonClient(connectPath, inputPath, outputPath, targetWidth, targetHeight,
+                                   parseEnergyFunction(energyName), protectPath, removePath, timeoutMs);
+        } catch (const std::exception& e) {
+            std::cerr << "An error occurred: " << e.what() << std::endl;
+            return -1;
+        }
+    }
+
+    // Raw working files: convert once, or carve the mapped pixels in place
+    bool rawInput = isRawImagePath(inputPath);
+    bool rawOutput = isRawImagePath(outputPath);
+    if (rawInput && rawOutput && inputPath == outputPath) {
+        std::cerr << "Error: A raw input is carved in place; write the result to a different file." << std::endl;
+        return -1;
+    }
+    if (rawOutput && !rawInput && targetWidth == -1 && targetHeight == -1 && !removeObject &&
+        protectPath.empty() && removePath.empty() && shapesPath.empty()) {
+        try {
+            convertToRawImage(inputPath, outputPath);
+            std::cout << "Raw working copy saved to: " << outputPath << std::endl;
+            return 0;
+        } catch (const std::exception& e) {
+            std::cerr << "An error occurred: " << e.what() << std::endl;
+            return -1;
+        }
+    }
+
     try {
-        // 1. Initialize SeamCarver
-        SeamCarver carver(inputPath, protectPath, removePath);
+        // 1. Get original dimensions if not specified, from the file header
+        std::unique_ptr<MappedImage> mapped;
+        cv::Size original;
+        if (rawInput) {
+            mapped.reset(new MappedImage(inputPath));
+            original = mapped->mat().size();
+            if (targetWidth == -1) targetWidth = original.width;
+            if (targetHeight == -1) targetHeight = original.height;
+        } else
+        if (probeImageSize(inputPath, original)) {
+            if (targetWidth == -1) targetWidth = original.width;
+            if (targetHeight == -1) targetHeight = original.height;
+        }
+
+        // 2. Initialize SeamCarver; JPEGs much larger than the target decode at reduced resolution
+        // Recorded and replayed seams must be in the coordinates of the full image.
+        bool reducedDecode = !parser.has("full-decode") && !removeObject && saveSeamsPath.empty() && applySeamsPath.empty() &&
+                             targetWidth != -1 && targetHeight != -1;
+        std::unique_ptr<SeamCarver> carverPtr;
+        bool carveInPlace = false;
+        if (mapped) {
+            cv::Mat protect = protectPath.empty() ? cv::Mat() : cv::imread(protectPath, cv::IMREAD_GRAYSCALE);
+            cv::Mat remove = removePath.empty() ? cv::Mat() : cv::imread(removePath, cv::IMREAD_GRAYSCALE);
+            if ((!protectPath.empty() && protect.empty()) || (!removePath.empty() && remove.empty())) {
+                throw std::runtime_error("Could not load mask image.");
+            }
+            carverPtr.reset(new SeamCarver(mapped->mat(), protect, remove));
+            // Only a pure reduction can overwrite its input: enlarging (or
+            // restoring after object removal) inserts seams found on pixels
+            // the in-place removals would already have moved.
+            carveInPlace = !restoreSize && targetWidth <= original.width && targetHeight <= original.height;
+            carverPtr->setCarveInPlace(carveInPlace);
+        } else {
+            carverPtr.reset(new SeamCarver(inputPath, protectPath, removePath,
+                                           reducedDecode ? cv::Size(targetWidth, targetHeight) : cv::Size()));
+        }
+        SeamCarver& carver = *carverPtr;
+        carver.setEnergyFunction(parseEnergyFunction(energyName));
+        if (!shapesPath.empty()) {
+            std::vector<MaskShape> shapes = loadMaskShapes(shapesPath);
+            // Shapes are authored on the full image; follow a reduced decode.
+            if (original.width > 0 && original.height > 0 &&
+                (carver.width() != original.width || carver.height() != original.height)) {
+                shapes = scaleMaskShapes(shapes, static_cast<double>(carver.width()) / original.width,
+                                         static_cast<double>(carver.height()) / original.height);
+            }
+            carver.addMaskShapes(shapes);
+        }
+        if (!autoProtect.empty()) {
+            int faces = protectFaces(carver, FaceDetector(cascadePath, faceOptions));
+            std::cout << "Protecting " << faces << " detected face(s)" << std::endl;
+        }
 
-        // 2. Get original dimensions if not specified
-        cv::Mat tempImg = cv::imread(inputPath);
+        // Formats the probe does not know: take the defaults from the decoded image
         if (targetWidth == -1) {
-            targetWidth = tempImg.cols;
+            targetWidth = carver.width();
         }
         if (targetHeight == -1) {
-            targetHeight = tempImg.rows;
+            targetHeight = carver.height();
         }
-        tempImg.release();
 
         // 3. Perform resize
-        carver.resize(targetWidth, targetHeight);
+        if (budgetMs > 0) {
+            carver.setTimeBudget(std::chrono::milliseconds(budgetMs));
+        }
+        if (hybrid.enabled) {
+            carver.setHybridCarving(hybrid);
+        }
+        carver.setProxyCarving(parser.get<int>("proxy"));
+        if (timeoutMs > 0) {
+            CancellationToken token;
+            token.cancelAfter(std::chrono::milliseconds(timeoutMs));
+            carver.setCancellationToken(token);
+        }
+        if (removeObject && removePath.empty() && shapesPath.empty()) {
+            throw std::invalid_argument("--remove-object needs a --remove mask or --shapes.");
+        }
+        SeamLog seamLog;
+        seamLog.inputWidth = carver.width();
+        seamLog.inputHeight = carver.height();
+        ResizeStatus status;
+        if (!applySeamsPath.empty()) {
+            seamLog = loadSeamLog(applySeamsPath);
+            if (seamLog.inputWidth != carver.width() || seamLog.inputHeight != carver.height()) {
+                throw std::invalid_argument("The seams were recorded on a " + std::to_string(seamLog.inputWidth) + "x" +
+                                            std::to_string(seamLog.inputHeight) + " image; this one is " +
+                                            std::to_string(carver.width()) + "x" + std::to_string(carver.height()) + ".");
+            }
+            // A replay that inserts seams grows past the mapped buffer.
+            bool inserts = std::any_of(seamLog.seams.begin(), seamLog.seams.end(), [](const SeamRecord& seam) { return seam.inserted; });
+            if (inserts || seamLog.outputWidth > carver.width() || seamLog.outputHeight > carver.height()) {
+                carveInPlace = false;
+                carver.setCarveInPlace(false);
+            }
+        }
+        try {
+            if (!applySeamsPath.empty()) {
+                status = carver.applySeams(seamLog.seams, seamLog.outputWidth, seamLog.outputHeight, seamLog.scales);
+            } else {
+                status = removeObject ? carver.removeObject(restoreSize) : carver.resize(targetWidth, targetHeight);
+            }
+        } catch (...) {
+            if (carveInPlace) {
+                commitInPlaceCarve(*mapped, carver.image());
+            }
+            throw;
+        }
+        if (carveInPlace) {
+            commitInPlaceCarve(*mapped, carver.image());
+        }
+        if (status == ResizeStatus::Cancelled) {
+            std::cerr << "Error: Resize did not finish within " << timeoutMs << " ms." << std::endl;
+            return -1;
+        }
 
-        // 4. Save result
-        carver.saveImage(outputPath);
+        // 4. Save result (and the seams, for replaying the carve elsewhere)
+        if (!saveSeamsPath.empty()) {
+            seamLog.outputWidth = carver.width();
+            seamLog.outputHeight = carver.height();
+            seamLog.seams = carver.seams();
+            seamLog.scales = carver.scaleSteps();
+            saveSeamLog(saveSeamsPath, seamLog);
+        }
+        if (rawOutput) {
+            writeRawImage(carver.image(), outputPath);
+            std::cout << "Image saved to: " << outputPath << std::endl;
+        } else {
+            carver.saveImage(outputPath);
+        }
+
+        // 5. Optionally report instrumentation
+        if (printStats) {
+            std::string json = carver.stats().toJson();
+            if (statsPath.empty()) {
+                std::cout << json << std::endl;
+            } else {
+                std::ofstream statsFile(statsPath);
+                statsFile << json << std::endl;
+                if (!statsFile) {
+                    throw std::runtime_error("Could not write stats to: " + statsPath);
+                }
+            }
+        }
 
-        // 5. Optionally show result
+        // 6. Optionally show result
         if (showResult) {
             carver.showImage("Seam Carving Result");
         }
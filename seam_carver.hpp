@@ -0,0 +1,717 @@
+/**
+ * @file seam_carver.hpp
+ * @author Utkarsh Sachan
+ * @brief Public C++ API of libseamcarver.
+ *
+ * `SeamCarver` can be constructed from file paths (as the CLI does), from an
+ * existing `cv::Mat`, or from a raw pixel buffer (pointer, stride, format).
+ * In-memory inputs are wrapped, not copied, and the result is available via
+ * `image()` without an encode/decode round trip through disk.
+ *
+ * For non-C++ callers, see the C ABI in seam_carver_c.h.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <initializer_list>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "energy.hpp"
+#include "logging.hpp"
+#include "vector_mask.hpp"
+
+class ThreadPool;
+
+/**
+ * @brief Called after each seam found by resize(): (seams done, seams total).
+ * Runs on the thread that called resize().
+ */
+using ProgressCallback = std::function<void(int, int)>;
+
+/**
+ * @brief Outcome of SeamCarver::resize().
+ */
+enum class ResizeStatus {
+    Completed, ///< The image has the target size.
+    Cancelled  ///< Stopped early; the image holds the seams applied so far.
+};
+
+/**
+ * @class CancellationToken
+ * @brief A cooperative stop request shared between a caller and resize().
+ *
+ * Copies share state, so a request handler can keep one copy and cancel it
+ * from another thread (or arm a deadline) while the carver checks it between
+ * seams and periodically inside the seam search.
+ */
+class CancellationToken {
+public:
+    CancellationToken() : m_state(std::make_shared<State>()) {}
+
+    /**
+     * @brief Requests cancellation. Thread-safe.
+     */
+    void cancel() const {
+        m_state->cancelled.store(true, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Cancels automatically once `timeout` has elapsed from now.
+     */
+    void cancelAfter(std::chrono::steady_clock::duration timeout) const {
+        m_state->deadline.store((std::chrono::steady_clock::now() + timeout).time_since_epoch().count(),
+                                std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief True once cancel() was called or the deadline has passed.
+     */
+    bool cancelled() const {
+        if (m_state->cancelled.load(std::memory_order_relaxed)) {
+            return true;
+        }
+        long long deadline = m_state->deadline.load(std::memory_order_relaxed);
+        return deadline != 0 && std::chrono::steady_clock::now().time_since_epoch().count() >= deadline;
+    }
+
+private:
+    struct State {
+        std::atomic<bool> cancelled{false};
+        std::atomic<long long> deadline{0}; ///< steady_clock ticks; 0 = none.
+    };
+    std::shared_ptr<State> m_state;
+};
+
+/**
+ * @brief Memory layouts accepted for raw pixel buffers.
+ * Channels are interleaved in BGR(A) order; 16-bit formats use native endianness.
+ * The order matches `sc_pixel_format` in seam_carver_c.h.
+ */
+enum class PixelFormat {
+    Gray8,
+    BGR8,
+    BGRA8,
+    Gray16,
+    BGR16,
+    BGRA16
+};
+
+/**
+ * @brief Returns the OpenCV matrix type (e.g. CV_8UC3) for a pixel format.
+ */
+int cvTypeFor(PixelFormat format);
+
+/**
+ * @brief Orientation of a seam.
+ */
+enum class SeamDirection {
+    Vertical,   ///< One column index per row (changes the width).
+    Horizontal  ///< One row index per column (changes the height).
+};
+
+/**
+ * @brief One seam produced by resize(), in the order it was applied.
+ *
+ * Removed seams are expressed in the coordinates of the image at the moment
+ * of removal, so replaying them in order reproduces the carve. Inserted seams
+ * are expressed in the coordinates of the image they were inserted into.
+ */
+struct SeamRecord {
+    SeamDirection direction;
+    bool inserted;            ///< True for seams added during expansion.
+    std::vector<int> indices; ///< Column (vertical) or row (horizontal) index per row/column.
+};
+
+/**
+ * @brief One scaling step of resize() (time budget or hybrid mode), placed
+ * among the seams in the order it was applied.
+ */
+struct ScaleRecord {
+    size_t position = 0; ///< Number of seams applied before this step.
+    int width = 0;       ///< Image size after the step.
+    int height = 0;
+};
+
+/**
+ * @brief Settings for hybrid carve-then-scale reductions (see setHybridCarving()).
+ */
+struct HybridOptions {
+    bool enabled = false;
+    /// Fraction of each dimension's reduction done by carving, in [0, 1]
+    /// (negative = automatic: carve at most 30% of the dimension).
+    double carveFraction = -1.0;
+    /// Stop carving once a seam's mean energy (0-255 scale) exceeds this
+    /// (negative = automatic: 40; 0 = no limit).
+    double maxSeamEnergy = -1.0;
+};
+
+/**
+ * @brief Wall time and counters accumulated by one phase of resize().
+ */
+struct PhaseStats {
+    double milliseconds = 0.0;    ///< Wall time spent in the phase.
+    long long calls = 0;          ///< Number of times the phase ran.
+    long long bytesAllocated = 0; ///< Bytes of result matrices allocated (excludes OpenCV temporaries).
+    long long pixelsTouched = 0;  ///< Input pixels processed.
+};
+
+/**
+ * @brief Instrumentation of the last resize().
+ *
+ * Always collected; the cost is two clock reads per phase call. The seam
+ * search for insertion is counted under the energy, search and removal
+ * phases, since it runs those on a temporary copy.
+ */
+struct ResizeStats {
+    int inputWidth = 0;
+    int inputHeight = 0;
+    int outputWidth = 0;
+    int outputHeight = 0;
+    std::string energyFunction;
+    int seamsRemoved = 0;
+    int seamsInserted = 0;
+    int seamsScaled = 0;       ///< Pixels of width/height changed by scaling (budget or hybrid mode).
+    int maxEnergyInterval = 1; ///< Most seams carved per energy computation.
+    int roiSearches = 0;       ///< Seam searches restricted to the removal region.
+    int roiFallbacks = 0;      ///< Restricted searches that needed the full DP after all.
+    int guidedSearches = 0;    ///< Seam searches restricted to a guide corridor (setSeamGuide()).
+    int proxySeams = 0;        ///< Seams found on a downscaled proxy and widened (setProxyCarving()).
+    bool cancelled = false;
+    double totalMilliseconds = 0.0;
+
+    PhaseStats energy;           ///< calculateEnergy (energy map and masks).
+    PhaseStats verticalSearch;   ///< findVerticalSeam (DP over the energy map).
+    PhaseStats horizontalSearch; ///< findHorizontalSeam (transpose + DP).
+    PhaseStats removal;          ///< Seam removal from image, masks and index map.
+    PhaseStats insertion;        ///< Seam insertion into image and index map.
+    PhaseStats scaling;          ///< Scaling in budget and hybrid modes.
+    PhaseStats proxy;            ///< Proxy downscale, its seam search and widening the seams.
+
+    /**
+     * @brief Serializes the stats as a single JSON object.
+     */
+    std::string toJson() const;
+};
+
+/**
+ * @class SeamCarver
+ * @brief Encapsulates all logic and data for the seam carving algorithm.
+ */
+class SeamCarver {
+public:
+    /**
+     * @brief Loads the image and optional masks.
+     * @param imagePath Path to the input image.
+     * @param protectMaskPath Path to the (optional) protection mask.
+     * @param removeMaskPath Path to the (optional) removal mask.
+     * @param targetSize The size the image will be resized to, if known. A JPEG
+     * at least twice that size in both dimensions is then decoded at 1/2, 1/4
+     * or 1/8 resolution in the DCT domain (as 8-bit BGR), leaving only the
+     * rest of the change to carving; masks are downscaled to match.
+     */
+    SeamCarver(const std::string& imagePath, const std::string& protectMaskPath, const std::string& removeMaskPath,
+               const cv::Size& targetSize = cv::Size());
+
+    /**
+     * @brief Wraps an in-memory image and optional masks (no pixel copy).
+     *
+     * The input is never written to unless setCarveInPlace() is enabled:
+     * carving allocates new matrices, so the caller's buffer may be shared safely.
+     * @param image 8/16-bit image with 1, 3 or 4 channels.
+     * @param protectionMask Optional single-channel 8-bit mask (non-zero = protect).
+     * @param removalMask Optional single-channel 8-bit mask (non-zero = remove).
+     */
+    explicit SeamCarver(const cv::Mat& image, const cv::Mat& protectionMask = cv::Mat(), const cv::Mat& removalMask = cv::Mat());
+
+    /**
+     * @brief Wraps a raw pixel buffer (no pixel copy).
+     * @param data Pointer to the first pixel of the top row.
+     * @param width Image width in pixels.
+     * @param height Image height in pixels.
+     * @param stride Bytes between the starts of consecutive rows (0 = tightly packed).
+     * @param format Pixel layout of the buffer.
+     * @return A carver reading from `data`; the buffer must outlive the first resize().
+     */
+    static SeamCarver fromBuffer(const void* data, int width, int height, size_t stride, PixelFormat format);
+
+    /**
+     * @brief Sets (or clears, with an empty matrix) the protection mask.
+     * Masks that do not match the image size are resized. The carver keeps
+     * masks as runs per row (see SpanMask), not as a matrix.
+     */
+    void setProtectionMask(const cv::Mat& mask);
+
+    /**
+     * @brief Sets (or clears, with an empty matrix) the removal mask.
+     * Masks that do not match the image size are resized.
+     */
+    void setRemovalMask(const cv::Mat& mask);
+
+    /**
+     * @brief Adds protected and removed shapes to the masks, without rasterizing
+     * them at full size (see vector_mask.hpp).
+     * @param shapes Rectangles and polygons in the coordinates of the current image.
+     */
+    void addMaskShapes(const std::vector<MaskShape>& shapes);
+
+    /**
+     * @brief Rasterizes the protection mask at the current image size (empty if none).
+     */
+    cv::Mat protectionMask() const;
+
+    /**
+     * @brief Selects the energy function used by subsequent calls to resize().
+     * @param energyFunction The energy policy to use (default: Sobel5).
+     */
+    void setEnergyFunction(EnergyFunction energyFunction);
+
+    /**
+     * @brief Lets resize() split its row and column loops across a thread pool.
+     * @param pool The pool to borrow helpers from (nullptr = single-threaded).
+     * @param threads Maximum number of threads working on this image, including
+     * the calling thread. Small images stay single-threaded regardless.
+     */
+    void setThreadPool(ThreadPool* pool, int threads);
+
+    /**
+     * @brief Replaces the logger (default: the process-wide default logger,
+     * which is silent unless setDefaultLogger() was called).
+     */
+    void setLogger(const Logger& logger);
+
+    /**
+     * @brief Sets (or clears, with an empty function) the progress callback.
+     */
+    void setProgressCallback(ProgressCallback callback);
+
+    /**
+     * @brief Gives resize() a time budget that it trades quality for.
+     *
+     * resize() measures its phases while it runs and re-plans after every
+     * seam: it carves exactly while the projection fits, then reuses each
+     * energy map for up to 16 seams (compacting it instead of recomputing),
+     * and finally scales the remaining width/height with cv::resize. A zero
+     * budget (the default) always carves exactly.
+     */
+    void setTimeBudget(std::chrono::milliseconds budget);
+
+    /**
+     * @brief Makes reductions carve only part of the way and area-resample the rest.
+     *
+     * For extreme reductions, carving every pixel away is slow and eventually
+     * cuts through content. In hybrid mode each reduced dimension is carved by
+     * at most `carveFraction` of its delta, stopping earlier once seams become
+     * expensive (`maxSeamEnergy`), and the remainder is scaled with INTER_AREA.
+     * Expansions are not affected.
+     */
+    void setHybridCarving(const HybridOptions& options);
+
+    /**
+     * @brief Finds reduction seams on a proxy downscaled by `factor` and
+     * applies them to the full-resolution image.
+     *
+     * Each proxy seam becomes a band of `factor` adjacent full-resolution
+     * seams. Between proxy rows the band moves one pixel per row, so every
+     * seam stays connected. All bands of a dimension are then removed in a
+     * single compaction pass. The energy and DP work shrink by about
+     * factor^2 and the per-seam copies disappear; seams are placed only to
+     * `factor`-pixel accuracy. Expansions are carved at full resolution.
+     * @param factor Proxy downscale factor (1 = off, the default).
+     */
+    void setProxyCarving(int factor);
+
+    /**
+     * @brief Removes seams inside the image's own buffer instead of copying
+     * the image for every seam.
+     *
+     * The image shrinks to a sub-matrix of the original buffer (same row
+     * stride). Meant for images backed by a memory-mapped file (see
+     * raw_image.hpp), so carving works on mapped pages and the OS decides
+     * what stays resident. The input buffer is overwritten. Seam insertion
+     * and scaling still allocate, and the seam search for an insertion
+     * always copies, since it must leave the original pixels intact.
+     */
+    void setCarveInPlace(bool inPlace);
+
+    /**
+     * @brief Warm-starts seam searches from another image's seams.
+     *
+     * The i-th seam search of resize() only considers pixels within
+     * `corridor` columns (rows, for horizontal seams) of `seams[i]`, typically
+     * searchedSeams() of the previous video frame. This keeps seams coherent
+     * between similar images and makes each search proportional to the
+     * corridor. Searches without a guide seam of matching length run
+     * unrestricted. Applies until replaced; pass no seams to clear.
+     */
+    void setSeamGuide(std::vector<std::vector<int>> seams, int corridor);
+
+    /**
+     * @brief Each seam search's result from the last resize(), in order and in
+     * the coordinates of the image searched (the input of setSeamGuide()).
+     */
+    const std::vector<std::vector<int>>& searchedSeams() const;
+
+    /**
+     * @brief Lets a caller stop resize() early (see CancellationToken).
+     */
+    void setCancellationToken(const CancellationToken& token);
+
+    /**
+     * @brief Resizes the image to the target dimensions.
+     *
+     * If the cancellation token fires, resize() stops at the next check and
+     * returns Cancelled. image(), seams() and indexMap() then describe the
+     * seams removed so far (a pending batch of insertions is discarded), and
+     * the output buffer, if any, is left untouched.
+     * @param newWidth The target width.
+     * @param newHeight The target height.
+     * @return Completed, or Cancelled if the token fired.
+     */
+    ResizeStatus resize(int newWidth, int newHeight);
+
+    /**
+     * @brief Carves away the removal-mask object, however many seams it takes.
+     *
+     * Removes vertical seams if the object's bounding box is narrower than it
+     * is tall (horizontal seams otherwise) until no removal-mask pixels
+     * remain, then optionally inserts seams to restore the original size.
+     * Cancellation behaves as in resize().
+     * @param restoreSize Re-expand to the original dimensions afterwards.
+     * @return Completed, or Cancelled if the token fired.
+     * @throws std::invalid_argument if there is no removal mask, or an output
+     * buffer is set without `restoreSize` (the result size is not known upfront).
+     */
+    ResizeStatus removeObject(bool restoreSize = false);
+
+    /**
+     * @brief Replays a recorded carve (see seams()) without energy maps or seam searches.
+     *
+     * Removed seams are cut out in order and each run of inserted seams is
+     * inserted as one batch, exactly as resize() applied them, so the result
+     * matches the original carve for any image of the same input size (for
+     * example a 16-bit master and its 8-bit preview). Where resize() scaled
+     * part of a dimension (time budget, hybrid mode), the replay applies the
+     * recorded scaling steps at the same points. Without them (older
+     * recordings), it infers a scaling step wherever a seam's length does not
+     * match the image, and scales to the target size at the end. Costs
+     * O(width x height) per seam. Cancellation behaves as in resize().
+     * @param seams Seams in the order resize() recorded them.
+     * @param newWidth The final width (the recorded output width).
+     * @param newHeight The final height (the recorded output height).
+     * @param scales Scaling steps recorded with the seams (scaleSteps()).
+     * @return Completed, or Cancelled if the token fired.
+     * @throws std::invalid_argument if a seam or scaling step does not fit the image it is applied to.
+     */
+    ResizeStatus applySeams(const std::vector<SeamRecord>& seams, int newWidth, int newHeight,
+                            const std::vector<ScaleRecord>& scales = std::vector<ScaleRecord>());
+
+    /**
+     * @brief Returns the current (carved) image without copying.
+     * The reference stays valid until the next resize() or destruction.
+     */
+    const cv::Mat& image() const;
+
+    /**
+     * @brief Current image width (the loaded width before any resize()).
+     */
+    int width() const;
+
+    /**
+     * @brief Current image height (the loaded height before any resize()).
+     */
+    int height() const;
+
+    /**
+     * @brief Makes resize() write its final image into a caller-owned buffer.
+     *
+     * The buffer must be `width` x `height` in the input pixel format, and
+     * resize() must target exactly that size. The last carving step writes
+     * into it directly, after which image() refers to the buffer.
+     * @param data Pointer to the first pixel of the top row (NULL clears).
+     * @param stride Bytes between row starts (0 = tightly packed).
+     */
+    void setOutputBuffer(void* data, int width, int height, size_t stride);
+
+    /**
+     * @brief Same as above for a preallocated matrix of the input type (empty clears).
+     */
+    void setOutputBuffer(const cv::Mat& buffer);
+
+    /**
+     * @brief Copies the current image into a caller-owned buffer.
+     * @param data Destination of image().cols x image().rows pixels in the input format.
+     * @param stride Bytes between row starts (0 = tightly packed).
+     */
+    void copyImageTo(void* data, size_t stride) const;
+
+    /**
+     * @brief Enables tracking of the source coordinate of every output pixel.
+     * Costs one extra CV_32SC2 compaction per seam; off by default.
+     */
+    void setTrackIndexMap(bool enabled);
+
+    /**
+     * @brief Returns the CV_32SC2 index map of the last resize().
+     *
+     * Each element holds the (x, y) of the input pixel the output pixel came
+     * from; inserted pixels map to the seam pixel they were interpolated from.
+     * Empty unless setTrackIndexMap(true) was called before resize().
+     */
+    const cv::Mat& indexMap() const;
+
+    /**
+     * @brief Returns the seams applied by the last resize(), in order.
+     */
+    const std::vector<SeamRecord>& seams() const;
+
+    /**
+     * @brief Returns the scaling steps of the last resize(), in order (empty
+     * unless a time budget or hybrid mode scaled part of the change).
+     */
+    const std::vector<ScaleRecord>& scaleSteps() const;
+
+    /**
+     * @brief Returns per-phase timing and counters of the last resize().
+     */
+    const ResizeStats& stats() const;
+
+    /**
+     * @brief Saves the processed image to a file.
+     * @param outputPath Path to save the new image.
+     */
+    void saveImage(const std::string& outputPath);
+
+    /**
+     * @brief Displays the current image in a window.
+     * @param windowName The name for the display window.
+     */
+    void showImage(const std::string& windowName);
+
+private:
+    cv::Mat m_image;
+    cv::Mat m_energyMap;
+    SpanMask m_protection;
+    SpanMask m_removal;
+    cv::Mat m_outputBuffer;
+    cv::Mat m_indexMap;
+    bool m_trackIndexMap = false;
+    std::vector<SeamRecord> m_seams;
+    std::vector<ScaleRecord> m_scales;
+    ResizeStats m_stats;
+    EnergyFunction m_energyFunction = EnergyFunction::Sobel5;
+    ThreadPool* m_pool = nullptr;
+    int m_threads = 1;
+    Logger m_logger = defaultLogger();
+    ProgressCallback m_progress;
+    CancellationToken m_cancellation;
+    int m_seamsTotal = 0;
+    double m_timeBudgetMs = 0.0;
+    std::chrono::steady_clock::time_point m_resizeStart;
+    bool m_reuseEnergy = false;
+    HybridOptions m_hybrid;
+    bool m_carveInPlace = false;
+    int m_proxyFactor = 1;
+    std::vector<std::vector<int>> m_seamGuide;
+    int m_guideCorridor = 0;
+    std::vector<std::vector<int>> m_searchedSeams;
+    double m_lastSeamEnergy = 0.0;
+
+    /**
+     * @brief Number of seams resize() plans to carve for a dimension change.
+     * @param delta Target minus current size.
+     * @param size Current size of the dimension.
+     */
+    int plannedSeams(int delta, int size) const;
+
+    /**
+     * @brief True if hybrid mode should stop carving at the last seam found.
+     */
+    bool seamTooExpensive() const;
+
+    /**
+     * @brief Unwinds the current resize() if the cancellation token fired.
+     */
+    void checkCancelled() const;
+
+    /**
+     * @brief Reports one more seam found to the progress callback.
+     */
+    void reportProgress() const;
+
+    /**
+     * @brief Runs `fn(begin, end)` over [0, rows), split across the pool if set.
+     */
+    void parallelRows(int rows, const std::function<void(int, int)>& fn) const;
+
+    /**
+     * @brief Validates the image type and attaches the masks after construction.
+     */
+    void validateInput(const cv::Mat& protectionMask, const cv::Mat& removalMask);
+
+    /**
+     * @brief Shared driver of resize() and removeObject(): resets the stats,
+     * dispatches the energy function once and finalizes the result.
+     * @param seamsTotal Seams planned, for progress reports.
+     * @param job Generic callable invoked with a default-constructed energy policy.
+     */
+    template <typename Job>
+    ResizeStatus runCarving(int seamsTotal, Job&& job);
+
+    /**
+     * @brief Runs the carving loops with a compile-time energy policy.
+     * @tparam EnergyPolicy One of the policies from energy.hpp.
+     */
+    template <typename EnergyPolicy>
+    void resizeWith(int newWidth, int newHeight);
+
+    /**
+     * @brief applySeams() body (policy-independent).
+     */
+    void replaySeams(const std::vector<SeamRecord>& seams, int newWidth, int newHeight,
+                     const std::vector<ScaleRecord>& scales);
+
+    /**
+     * @brief Object-removal loop of removeObject() for one energy policy.
+     */
+    template <typename EnergyPolicy>
+    void removeObjectWith(SeamDirection direction, int originalWidth, int originalHeight, bool restoreSize);
+
+    /**
+     * @brief Removes up to `count` seams, stopping early if the time budget
+     * runs out or (hybrid mode) seams become too expensive.
+     * @param untilObjectGone Also stop once no removal-mask pixels remain, or
+     * when the next seam can no longer reach them.
+     * @return The number of seams removed.
+     */
+    template <typename EnergyPolicy>
+    int removeSeams(SeamDirection direction, int count, bool untilObjectGone = false);
+
+    /**
+     * @brief removeSeams() through a downscaled proxy (see setProxyCarving()).
+     * Falls back to removeSeams() when the proxy would be too small.
+     * @return The number of seams removed.
+     */
+    template <typename EnergyPolicy>
+    int removeSeamsViaProxy(SeamDirection direction, int count);
+
+    /**
+     * @brief Removes many seams from the image, masks and index map in one pass.
+     * @param removed CV_32S matrix, one row per image row (vertical) or column
+     * (horizontal), holding the sorted original indices to remove.
+     */
+    void removeSeamSet(SeamDirection direction, const cv::Mat& removed);
+
+    /**
+     * @brief Recomputes the energy map unless the compacted one may be reused.
+     * @param carvedSinceEnergy Seams carved on the current map (reset on recompute).
+     * @param interval Seams allowed per energy computation.
+     */
+    template <typename EnergyPolicy>
+    void refreshEnergy(int& carvedSinceEnergy, int interval);
+
+    /**
+     * @brief Plans the next seam against the time budget from measured phase costs.
+     * @return Seams per energy computation (1 = exact), or 0 if no seam fits.
+     */
+    int energyInterval() const;
+
+    /**
+     * @brief Scales image, masks and index map to the given size (budget and hybrid modes).
+     */
+    void scaleTo(int cols, int rows);
+
+    /**
+     * @brief Finds `count` seams for insertion on a temporarily shrinking copy.
+     * Fewer are returned if the time budget runs out.
+     * @return The seams in the coordinates of the current image.
+     */
+    template <typename EnergyPolicy>
+    std::vector<std::vector<int>> findInsertionSeams(SeamDirection direction, int count);
+
+    /**
+     * @brief Allocates the next image, reusing the output buffer for the final step.
+     */
+    cv::Mat allocateImage(int rows, int cols) const;
+
+    /**
+     * @brief Calculates the energy map with the given policy and applies masks.
+     * @tparam EnergyPolicy One of the policies from energy.hpp.
+     */
+    template <typename EnergyPolicy>
+    void calculateEnergy();
+
+    /**
+     * @brief Finds the lowest-energy vertical seam using dynamic programming.
+     * @return A vector of column indices, one for each row.
+     */
+    std::vector<int> findVerticalSeam();
+
+    /**
+     * @brief Finds the lowest-energy horizontal seam.
+     * @return A vector of row indices, one for each column.
+     */
+    std::vector<int> findHorizontalSeam();
+
+    /**
+     * @brief Runs the seam DP over the current energy map.
+     *
+     * With a removal region, the DP first runs only over the cells a seam
+     * through that region can reach (its bounding box, widened by one column
+     * per row of distance from it). Any seam avoiding the region costs at
+     * least 0, so a negative banded optimum is the global optimum; otherwise
+     * the full DP runs.
+     * @param stats The phase that the allocations and pixels are counted against.
+     * @param removal Bounding box of the removal mask in energy-map coordinates (empty = none).
+     * @param guide Restricts the DP to the guide corridor instead (see setSeamGuide()).
+     */
+    std::vector<int> traceVerticalSeam(PhaseStats& stats, const cv::Rect& removal = cv::Rect(),
+                                       const std::vector<int>* guide = nullptr);
+
+    /**
+     * @brief The guide seam for the next search, if one of this length was set.
+     */
+    const std::vector<int>* seamGuide(int length) const;
+
+    /**
+     * @brief Bounding box of the remaining removal-mask pixels (empty if none).
+     */
+    cv::Rect removalBounds() const;
+
+    /**
+     * @brief Counts one carving step's allocations and the pixels it reads.
+     * @param image The new image (not counted if it is the output buffer).
+     * @param others Mask and index-map matrices allocated alongside (may be empty).
+     */
+    void countAllocation(PhaseStats& stats, const cv::Mat& image, std::initializer_list<const cv::Mat*> others) const;
+
+    /**
+     * @brief Removes a vertical seam from the image and masks.
+     * @param seam The seam to remove (vector of column indices).
+     */
+    void removeVerticalSeam(const std::vector<int>& seam);
+
+    /**
+     * @brief Removes a horizontal seam from the image and masks.
+     * @param seam The seam to remove (vector of row indices).
+     */
+    void removeHorizontalSeam(const std::vector<int>& seam);
+
+    /**
+     * @brief Adds multiple vertical seams to the image.
+     * @param seams A vector of seams to add.
+     */
+    void addVerticalSeams(std::vector<std::vector<int>>& seams);
+
+    /**
+     * @brief Adds multiple horizontal seams to the image.
+     * @param seams A vector of seams to add.
+     */
+    void addHorizontalSeams(std::vector<std::vector<int>>& seams);
+};
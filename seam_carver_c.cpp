@@ -0,0 +1,244 @@
+/**
+ * @file seam_carver_c.cpp
+ * @author Utkarsh Sachan
+ * @brief C ABI wrapper around `SeamCarver`. Converts exceptions to status codes.
+ */
+
+#include "seam_carver_c.h"
+
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "seam_carver.hpp"
+
+struct sc_carver {
+    std::unique_ptr<SeamCarver> carver;
+    CancellationToken cancellation;
+    std::string statsJson;
+};
+
+namespace {
+
+thread_local std::string g_lastError;
+
+/**
+ * @brief Runs `fn`, translating exceptions into status codes and sc_last_error().
+ */
+template <typename Fn>
+int guarded(Fn&& fn) {
+    try {
+        fn();
+        g_lastError.clear();
+        return SC_OK;
+    } catch (const std::invalid_argument& e) {
+        g_lastError = e.what();
+        return SC_ERROR_INVALID_ARGUMENT;
+    } catch (const std::runtime_error& e) {
+        g_lastError = e.what();
+        return SC_ERROR_UNSUPPORTED_FORMAT;
+    } catch (const std::exception& e) {
+        g_lastError = e.what();
+        return SC_ERROR_INTERNAL;
+    } catch (...) {
+        g_lastError = "Unknown error";
+        return SC_ERROR_INTERNAL;
+    }
+}
+
+int invalid(const char* message) {
+    g_lastError = message;
+    return SC_ERROR_INVALID_ARGUMENT;
+}
+
+cv::Mat wrapMask(const void* data, int width, int height, size_t stride) {
+    if (data == nullptr) {
+        return cv::Mat();
+    }
+    if (width <= 0 || height <= 0) {
+        throw std::invalid_argument("Invalid mask dimensions.");
+    }
+    return cv::Mat(height, width, CV_8UC1, const_cast<void*>(data), stride);
+}
+
+} // namespace
+
+extern "C" {
+
+int sc_create_from_buffer(const void* data, int width, int height, size_t stride,
+                          sc_pixel_format format, sc_carver** out) {
+    if (out == nullptr) return invalid("Output handle pointer is NULL.");
+    *out = nullptr;
+    if (format < SC_FORMAT_GRAY8 || format > SC_FORMAT_BGRA16) return invalid("Unknown pixel format.");
+    return guarded([&] {
+        std::unique_ptr<sc_carver> handle(new sc_carver);
+        handle->carver.reset(new SeamCarver(SeamCarver::fromBuffer(data, width, height, stride, static_cast<PixelFormat>(format))));
+        *out = handle.release();
+    });
+}
+
+int sc_create_from_file(const char* path, sc_carver** out) {
+    if (out == nullptr || path == nullptr) return invalid("NULL argument.");
+    *out = nullptr;
+    return guarded([&] {
+        std::unique_ptr<sc_carver> handle(new sc_carver);
+        handle->carver.reset(new SeamCarver(path, "", ""));
+        *out = handle.release();
+    });
+}
+
+void sc_destroy(sc_carver* carver) {
+    delete carver;
+}
+
+int sc_set_protection_mask(sc_carver* carver, const void* data, int width, int height, size_t stride) {
+    if (carver == nullptr) return invalid("Carver handle is NULL.");
+    return guarded([&] { carver->carver->setProtectionMask(wrapMask(data, width, height, stride)); });
+}
+
+int sc_set_removal_mask(sc_carver* carver, const void* data, int width, int height, size_t stride) {
+    if (carver == nullptr) return invalid("Carver handle is NULL.");
+    return guarded([&] { carver->carver->setRemovalMask(wrapMask(data, width, height, stride)); });
+}
+
+int sc_set_energy(sc_carver* carver, sc_energy energy) {
+    if (carver == nullptr) return invalid("Carver handle is NULL.");
+    if (energy < SC_ENERGY_SOBEL3 || energy > SC_ENERGY_SALIENCY) return invalid("Unknown energy function.");
+    carver->carver->setEnergyFunction(static_cast<EnergyFunction>(energy));
+    return SC_OK;
+}
+
+int sc_resize(sc_carver* carver, int width, int height) {
+    if (carver == nullptr) return invalid("Carver handle is NULL.");
+    ResizeStatus status = ResizeStatus::Completed;
+    int result = guarded([&] {
+        carver->carver->setCancellationToken(carver->cancellation);
+        status = carver->carver->resize(width, height);
+    });
+    return (result == SC_OK && status == ResizeStatus::Cancelled) ? SC_CANCELLED : result;
+}
+
+int sc_remove_object(sc_carver* carver, int restore_size) {
+    if (carver == nullptr) return invalid("Carver handle is NULL.");
+    ResizeStatus status = ResizeStatus::Completed;
+    int result = guarded([&] {
+        carver->carver->setCancellationToken(carver->cancellation);
+        status = carver->carver->removeObject(restore_size != 0);
+    });
+    return (result == SC_OK && status == ResizeStatus::Cancelled) ? SC_CANCELLED : result;
+}
+
+int sc_set_time_budget_ms(sc_carver* carver, long long milliseconds) {
+    if (carver == nullptr) return invalid("Carver handle is NULL.");
+    carver->carver->setTimeBudget(std::chrono::milliseconds(milliseconds));
+    return SC_OK;
+}
+
+int sc_set_hybrid(sc_carver* carver, double carve_fraction, double max_seam_energy) {
+    if (carver == nullptr) return invalid("Carver handle is NULL.");
+    return guarded([&] {
+        HybridOptions options;
+        options.enabled = true;
+        options.carveFraction = carve_fraction;
+        options.maxSeamEnergy = max_seam_energy;
+        carver->carver->setHybridCarving(options);
+    });
+}
+
+int sc_set_proxy_factor(sc_carver* carver, int factor) {
+    if (carver == nullptr) return invalid("Carver handle is NULL.");
+    return guarded([&] { carver->carver->setProxyCarving(factor); });
+}
+
+int sc_cancel(sc_carver* carver) {
+    if (carver == nullptr) return invalid("Carver handle is NULL.");
+    carver->cancellation.cancel();
+    return SC_OK;
+}
+
+int sc_cancel_after_ms(sc_carver* carver, long long milliseconds) {
+    if (carver == nullptr) return invalid("Carver handle is NULL.");
+    carver->cancellation.cancelAfter(std::chrono::milliseconds(milliseconds));
+    return SC_OK;
+}
+
+int sc_get_result(const sc_carver* carver, const void** data, int* width, int* height, size_t* stride) {
+    if (carver == nullptr || data == nullptr) return invalid("NULL argument.");
+    const cv::Mat& image = carver->carver->image();
+    *data = image.data;
+    if (width) *width = image.cols;
+    if (height) *height = image.rows;
+    if (stride) *stride = image.step;
+    return SC_OK;
+}
+
+int sc_set_output_buffer(sc_carver* carver, void* data, int width, int height, size_t stride) {
+    if (carver == nullptr) return invalid("Carver handle is NULL.");
+    return guarded([&] { carver->carver->setOutputBuffer(data, width, height, stride); });
+}
+
+int sc_copy_result(const sc_carver* carver, void* data, size_t stride) {
+    if (carver == nullptr) return invalid("Carver handle is NULL.");
+    return guarded([&] { carver->carver->copyImageTo(data, stride); });
+}
+
+int sc_set_track_index_map(sc_carver* carver, int enabled) {
+    if (carver == nullptr) return invalid("Carver handle is NULL.");
+    carver->carver->setTrackIndexMap(enabled != 0);
+    return SC_OK;
+}
+
+int sc_get_index_map(const sc_carver* carver, const int** data, int* width, int* height, size_t* stride) {
+    if (carver == nullptr || data == nullptr) return invalid("NULL argument.");
+    const cv::Mat& map = carver->carver->indexMap();
+    if (map.empty()) return invalid("Index map tracking was not enabled.");
+    *data = map.ptr<int>(0);
+    if (width) *width = map.cols;
+    if (height) *height = map.rows;
+    if (stride) *stride = map.step;
+    return SC_OK;
+}
+
+int sc_get_seam_count(const sc_carver* carver, int* count) {
+    if (carver == nullptr || count == nullptr) return invalid("NULL argument.");
+    *count = static_cast<int>(carver->carver->seams().size());
+    return SC_OK;
+}
+
+int sc_get_seam(const sc_carver* carver, int index, int* vertical, int* inserted,
+                const int** indices, int* length) {
+    if (carver == nullptr || indices == nullptr) return invalid("NULL argument.");
+    const std::vector<SeamRecord>& seams = carver->carver->seams();
+    if (index < 0 || index >= static_cast<int>(seams.size())) return invalid("Seam index out of range.");
+    const SeamRecord& seam = seams[index];
+    if (vertical) *vertical = (seam.direction == SeamDirection::Vertical) ? 1 : 0;
+    if (inserted) *inserted = seam.inserted ? 1 : 0;
+    *indices = seam.indices.data();
+    if (length) *length = static_cast<int>(seam.indices.size());
+    return SC_OK;
+}
+
+int sc_set_progress_callback(sc_carver* carver, sc_progress_fn callback, void* user_data) {
+    if (carver == nullptr) return invalid("NULL carver.");
+    if (callback == nullptr) {
+        carver->carver->setProgressCallback(nullptr);
+    } else {
+        carver->carver->setProgressCallback([callback, user_data](int done, int total) { callback(done, total, user_data); });
+    }
+    return SC_OK;
+}
+
+int sc_get_stats_json(sc_carver* carver, const char** json) {
+    if (carver == nullptr || json == nullptr) return invalid("NULL argument.");
+    carver->statsJson = carver->carver->stats().toJson();
+    *json = carver->statsJson.c_str();
+    return SC_OK;
+}
+
+const char* sc_last_error(void) {
+    return g_lastError.c_str();
+}
+
+} // extern "C"
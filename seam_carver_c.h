@@ -0,0 +1,198 @@
+/**
+ * @file seam_carver_c.h
+ * @author Utkarsh Sachan
+ * @brief C ABI of libseamcarver for non-C++ callers.
+ *
+ * All functions return SC_OK (0) on success or a negative status code. On
+ * failure, sc_last_error() returns a human-readable message for the calling
+ * thread. Input buffers are wrapped without copying; the result is exposed
+ * as a pointer into the carver's own storage.
+ *
+ * Example:
+ *   sc_carver* carver = NULL;
+ *   if (sc_create_from_buffer(pixels, w, h, stride, SC_FORMAT_BGR8, &carver) == SC_OK &&
+ *       sc_resize(carver, w / 2, h) == SC_OK) {
+ *       const void* out; int ow, oh; size_t ostride;
+ *       sc_get_result(carver, &out, &ow, &oh, &ostride);
+ *       ...
+ *   }
+ *   sc_destroy(carver);
+ */
+
+#ifndef SEAM_CARVER_C_H
+#define SEAM_CARVER_C_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Opaque handle to a SeamCarver instance. */
+typedef struct sc_carver sc_carver;
+
+/** @brief Status codes. */
+typedef enum {
+    SC_OK = 0,
+    SC_CANCELLED = 1, /**< sc_resize() stopped early; the result holds the seams applied so far. */
+    SC_ERROR_INVALID_ARGUMENT = -1,
+    SC_ERROR_UNSUPPORTED_FORMAT = -2,
+    SC_ERROR_INTERNAL = -3
+} sc_status;
+
+/** @brief Pixel layouts (interleaved BGR(A), native-endian 16-bit). Mirrors PixelFormat. */
+typedef enum {
+    SC_FORMAT_GRAY8 = 0,
+    SC_FORMAT_BGR8 = 1,
+    SC_FORMAT_BGRA8 = 2,
+    SC_FORMAT_GRAY16 = 3,
+    SC_FORMAT_BGR16 = 4,
+    SC_FORMAT_BGRA16 = 5
+} sc_pixel_format;
+
+/** @brief Energy functions. Mirrors EnergyFunction. */
+typedef enum {
+    SC_ENERGY_SOBEL3 = 0,
+    SC_ENERGY_SOBEL5 = 1,
+    SC_ENERGY_SCHARR = 2,
+    SC_ENERGY_DUAL_GRADIENT = 3,
+    SC_ENERGY_RGB_GRADIENT = 4,
+    SC_ENERGY_ENTROPY = 5,
+    SC_ENERGY_SALIENCY = 6
+} sc_energy;
+
+/**
+ * @brief Creates a carver over a caller-owned pixel buffer (not copied).
+ * The buffer must stay valid until the first sc_resize() returns.
+ * @param stride Bytes between row starts; 0 means tightly packed.
+ */
+int sc_create_from_buffer(const void* data, int width, int height, size_t stride,
+                          sc_pixel_format format, sc_carver** out);
+
+/** @brief Creates a carver by decoding an image file. */
+int sc_create_from_file(const char* path, sc_carver** out);
+
+/** @brief Destroys a carver. Passing NULL is a no-op. */
+void sc_destroy(sc_carver* carver);
+
+/**
+ * @brief Sets (data != NULL) or clears (data == NULL) the 8-bit protection mask.
+ * The mask is copied if its size differs from the image (it is then resized).
+ */
+int sc_set_protection_mask(sc_carver* carver, const void* data, int width, int height, size_t stride);
+
+/** @brief Sets or clears the 8-bit removal mask (see sc_set_protection_mask). */
+int sc_set_removal_mask(sc_carver* carver, const void* data, int width, int height, size_t stride);
+
+/** @brief Selects the energy function used by sc_resize(). */
+int sc_set_energy(sc_carver* carver, sc_energy energy);
+
+/**
+ * @brief Carves the image to the given size.
+ * @return SC_OK, SC_CANCELLED (see sc_cancel()) or an error status.
+ */
+int sc_resize(sc_carver* carver, int width, int height);
+
+/**
+ * @brief Carves away the removal-mask object (see sc_set_removal_mask()),
+ * choosing the seam direction itself and stopping once the object is gone.
+ * @param restore_size Non-zero to re-expand to the original size afterwards.
+ * @return SC_OK, SC_CANCELLED or an error status.
+ */
+int sc_remove_object(sc_carver* carver, int restore_size);
+
+/**
+ * @brief Gives sc_resize() a time budget (0 = exact carving, the default).
+ * Over budget, seams reuse energy maps and the remaining delta is finally
+ * scaled, so the result always has the requested size.
+ */
+int sc_set_time_budget_ms(sc_carver* carver, long long milliseconds);
+
+/**
+ * @brief Enables hybrid carve-then-scale reductions (see SeamCarver::setHybridCarving()).
+ * @param carve_fraction Share of each reduction done by carving, 0-1 (negative = automatic).
+ * @param max_seam_energy Stop carving above this mean seam energy, 0-255 (negative = automatic, 0 = no limit).
+ * Pass a carve fraction of 1 and a seam limit of 0 to restore plain carving.
+ */
+int sc_set_hybrid(sc_carver* carver, double carve_fraction, double max_seam_energy);
+
+/**
+ * @brief Finds reduction seams on a proxy downscaled by `factor` (see SeamCarver::setProxyCarving()).
+ * @param factor Proxy downscale factor (1 = off, the default).
+ */
+int sc_set_proxy_factor(sc_carver* carver, int factor);
+
+/**
+ * @brief Makes a running (or the next) sc_resize() stop early with SC_CANCELLED.
+ * Safe to call from any thread. A cancelled carver stays cancelled.
+ */
+int sc_cancel(sc_carver* carver);
+
+/** @brief Cancels sc_resize() automatically once `milliseconds` have elapsed from now. */
+int sc_cancel_after_ms(sc_carver* carver, long long milliseconds);
+
+/**
+ * @brief Returns a pointer to the current image (no copy).
+ * Valid until the next sc_resize() or sc_destroy(). The pixel format is the
+ * input format.
+ */
+int sc_get_result(const sc_carver* carver, const void** data, int* width, int* height, size_t* stride);
+
+/**
+ * @brief Makes sc_resize() write its final image into a caller-owned buffer.
+ * The buffer uses the input pixel format and must match the size passed to
+ * sc_resize(). Pass data == NULL to clear.
+ */
+int sc_set_output_buffer(sc_carver* carver, void* data, int width, int height, size_t stride);
+
+/** @brief Copies the current image into a caller-owned buffer of the result size. */
+int sc_copy_result(const sc_carver* carver, void* data, size_t stride);
+
+/** @brief Enables (non-zero) or disables tracking of the output-to-input index map. */
+int sc_set_track_index_map(sc_carver* carver, int enabled);
+
+/**
+ * @brief Returns the index map of the last sc_resize() (no copy).
+ * Each output pixel holds two int32 values: the source x and y in the input.
+ * Fails if tracking was not enabled before sc_resize().
+ */
+int sc_get_index_map(const sc_carver* carver, const int** data, int* width, int* height, size_t* stride);
+
+/** @brief Returns the number of seams applied by the last sc_resize(). */
+int sc_get_seam_count(const sc_carver* carver, int* count);
+
+/**
+ * @brief Returns one seam of the last sc_resize() (no copy).
+ * @param vertical Set to 1 for vertical seams (one column per row), 0 otherwise.
+ * @param inserted Set to 1 for seams added during expansion.
+ * @param indices Set to the per-row (or per-column) indices.
+ * @param length Set to the number of indices.
+ */
+int sc_get_seam(const sc_carver* carver, int index, int* vertical, int* inserted,
+                const int** indices, int* length);
+
+/**
+ * @brief Called after each seam found by sc_resize(), on the calling thread.
+ * @param done Seams found so far.
+ * @param total Seams the resize needs in total.
+ */
+typedef void (*sc_progress_fn)(int done, int total, void* user_data);
+
+/** @brief Sets (or clears, with NULL) the progress callback. */
+int sc_set_progress_callback(sc_carver* carver, sc_progress_fn callback, void* user_data);
+
+/**
+ * @brief Returns per-phase timing and counters of the last sc_resize() as JSON.
+ * @param json Set to a NUL-terminated string owned by the carver, valid until
+ * the next call on this carver.
+ */
+int sc_get_stats_json(sc_carver* carver, const char** json);
+
+/** @brief Returns the last error message on this thread ("" if none). */
+const char* sc_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SEAM_CARVER_C_H */
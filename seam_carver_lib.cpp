@@ -0,0 +1,1650 @@
+/**
+ * @file seam_carver_lib.cpp
+ * @author Utkarsh Sachan
+ * @brief Implementation of the `SeamCarver` class (libseamcarver).
+ *
+ * Build (static library):
+ * g++ -std=c++17 -O2 -fPIC -pthread -c seam_carver_lib.cpp seam_carver_c.cpp seam_file.cpp vector_mask.cpp `pkg-config --cflags opencv4`
+ * ar rcs libseamcarver.a seam_carver_lib.o seam_carver_c.o seam_file.o vector_mask.o
+ *
+ * Build (shared library):
+ * g++ -std=c++17 -O2 -fPIC -pthread -shared -o libseamcarver.so seam_carver_lib.cpp seam_carver_c.cpp seam_file.cpp vector_mask.cpp `pkg-config --cflags --libs opencv4`
+ */
+
+#include "seam_carver.hpp"
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <limits>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#include "image_probe.hpp"
+#include "pixel_types.hpp"
+#include "thread_pool.hpp"
+
+// Use high-precision constants for energy modification
+const double MAX_ENERGY = 1e9;
+const double MIN_ENERGY = -1e9;
+
+// Rows of the seam DP between two cancellation checks.
+const int CANCELLATION_CHECK_ROWS = 128;
+
+// Time-budget planning: the most seams carved per energy map, and the share
+// of the budget held back for the scaling fallback.
+const int MAX_ENERGY_INTERVAL = 16;
+const double SCALE_RESERVE_FRACTION = 0.1;
+
+// Automatic hybrid mode: carve at most this share of a dimension, and stop at
+// seams whose mean normalized energy shows they would cut through content.
+const double AUTO_HYBRID_CARVE_SHARE = 0.3;
+const double AUTO_HYBRID_MAX_SEAM_ENERGY = 40.0;
+
+// Proxy carving falls back to full resolution below this proxy width/height;
+// seams found on smaller proxies are too coarse to be worth widening.
+const int MIN_PROXY_SIZE = 16;
+
+// Below these sizes, splitting a loop costs more than it saves.
+const int MIN_ROWS_PER_THREAD = 64;
+const int MIN_DP_COLUMNS_PER_THREAD = 2048;
+
+namespace {
+
+/**
+ * @brief Thrown by checkCancelled() and caught by resize(); never escapes.
+ */
+struct ResizeCancelled {};
+
+/**
+ * @brief Adds the wall time of a scope to a phase and counts the call.
+ */
+class PhaseTimer {
+public:
+    explicit PhaseTimer(PhaseStats& stats) : m_stats(stats), m_start(std::chrono::steady_clock::now()) {
+        ++m_stats.calls;
+    }
+    ~PhaseTimer() {
+        m_stats.milliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+    }
+
+private:
+    PhaseStats& m_stats;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+/**
+ * @brief Size of a matrix's pixel data in bytes (0 for an empty matrix).
+ */
+long long matBytes(const cv::Mat& mat) {
+    return static_cast<long long>(mat.total() * mat.elemSize());
+}
+
+/**
+ * @brief Writes one phase as a JSON object.
+ */
+void writePhaseJson(std::ostream& out, const char* name, const PhaseStats& phase) {
+    out << "\"" << name << "\":{\"ms\":" << phase.milliseconds << ",\"calls\":" << phase.calls
+        << ",\"bytes_allocated\":" << phase.bytesAllocated << ",\"pixels_touched\":" << phase.pixelsTouched << "}";
+}
+
+/**
+ * @brief Chooses `cv::imread` flags for the input image.
+ *
+ * Formats that can carry alpha or high bit depth (PNG, TIFF, WebP, JPEG 2000)
+ * are loaded unchanged. Everything else keeps bit depth and channel count but
+ * still honors EXIF orientation, which IMREAD_UNCHANGED would ignore.
+ */
+std::string lowercaseExtension(const std::string& path) {
+    std::string ext = path.substr(path.find_last_of('.') + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char ch) { return std::tolower(ch); });
+    return ext;
+}
+
+int imreadFlagsFor(const std::string& path) {
+    std::string ext = lowercaseExtension(path);
+    if (ext == "png" || ext == "tif" || ext == "tiff" || ext == "webp" || ext == "jp2") {
+        return cv::IMREAD_UNCHANGED;
+    }
+    return cv::IMREAD_ANYDEPTH | cv::IMREAD_ANYCOLOR;
+}
+
+/**
+ * @brief Picks the largest DCT-domain JPEG reduction (1/2, 1/4 or 1/8) whose
+ * decoded size still covers `target` in both dimensions.
+ * @return The divisor (1 = decode at full resolution).
+ */
+int jpegReductionFor(const std::string& path, const cv::Size& target) {
+    std::string ext = lowercaseExtension(path);
+    if (target.width <= 0 || target.height <= 0 || (ext != "jpg" && ext != "jpeg" && ext != "jpe")) {
+        return 1;
+    }
+    cv::Size original;
+    if (!probeImageSize(path, original)) {
+        return 1;
+    }
+    for (int divisor : {8, 4, 2}) {
+        if (original.width / divisor >= target.width && original.height / divisor >= target.height) {
+            return divisor;
+        }
+    }
+    return 1;
+}
+
+int reducedColorFlag(int divisor) {
+    switch (divisor) {
+        case 2: return cv::IMREAD_REDUCED_COLOR_2;
+        case 4: return cv::IMREAD_REDUCED_COLOR_4;
+        default: return cv::IMREAD_REDUCED_COLOR_8;
+    }
+}
+
+/**
+ * @brief Downscales a mask to a reduced-resolution image. A pixel stays
+ * marked if any source pixel it covers was, so thin masked details survive.
+ */
+cv::Mat reduceMask(const cv::Mat& mask, const cv::Size& size) {
+    if (mask.empty() || mask.size() == size) {
+        return mask;
+    }
+    cv::Mat reduced;
+    cv::resize(mask, reduced, size, 0, 0, cv::INTER_AREA);
+    cv::threshold(reduced, reduced, 0, 255, cv::THRESH_BINARY);
+    return reduced;
+}
+
+/**
+ * @brief Checks a mask against the image, resizing it when the size differs.
+ * @return The (possibly resized) mask, or an empty matrix if `mask` is empty.
+ */
+cv::Mat conformMask(const cv::Mat& mask, const cv::Size& imageSize, const char* name, const Logger& logger) {
+    if (mask.empty()) {
+        return cv::Mat();
+    }
+    if (mask.type() != CV_8UC1) {
+        throw std::invalid_argument(std::string(name) + " mask must be single-channel 8-bit.");
+    }
+    if (mask.size() != imageSize) {
+        logger.warning([&] { return std::string(name) + " mask dimensions do not match image. Resizing mask."; });
+        cv::Mat resized;
+        cv::resize(mask, resized, imageSize);
+        return resized;
+    }
+    return mask;
+}
+
+// ---
+// Pixel-type generic helpers. `Pixel` is one of uchar, ushort, cv::Vec3b,
+// cv::Vec3w, cv::Vec4b or cv::Vec4w (see dispatchPixelType).
+// ---
+
+/**
+ * @brief Copies rows [rowBegin, rowEnd) of `src` into `dst` without the vertical seam.
+ * @param src The source matrix.
+ * @param dst Preallocated rows x (cols - 1) matrix of the same type.
+ * @param seam The seam to remove (vector of column indices).
+ */
+template <typename Pixel>
+void removeVerticalSeamInto(const cv::Mat& src, cv::Mat& dst, const std::vector<int>& seam, int rowBegin, int rowEnd) {
+    int cols = src.cols;
+
+    for (int r = rowBegin; r < rowEnd; ++r) {
+        const Pixel* in = src.ptr<Pixel>(r);
+        Pixel* out = dst.ptr<Pixel>(r);
+        int seamCol = seam[r];
+        std::copy(in, in + seamCol, out);
+        std::copy(in + seamCol + 1, in + cols, out + seamCol);
+    }
+}
+
+/**
+ * @brief Fills output rows [rowBegin, rowEnd) of `dst` from `src` without the horizontal seam.
+ * Works row by row so both source and destination are read sequentially.
+ * @param src The source matrix.
+ * @param dst Preallocated (rows - 1) x cols matrix of the same type.
+ * @param seam The seam to remove (vector of row indices).
+ */
+template <typename Pixel>
+void removeHorizontalSeamInto(const cv::Mat& src, cv::Mat& dst, const std::vector<int>& seam, int rowBegin, int rowEnd) {
+    int cols = src.cols;
+
+    for (int r = rowBegin; r < rowEnd; ++r) {
+        const Pixel* same = src.ptr<Pixel>(r);
+        const Pixel* below = src.ptr<Pixel>(r + 1);
+        Pixel* out = dst.ptr<Pixel>(r);
+        for (int c = 0; c < cols; ++c) {
+            out[c] = (r < seam[c]) ? same[c] : below[c];
+        }
+    }
+}
+
+/**
+ * @brief Removes the vertical seam from rows [rowBegin, rowEnd) within the
+ * matrix's own buffer; afterwards the last column is stale.
+ */
+template <typename Pixel>
+void removeVerticalSeamInPlace(cv::Mat& mat, const std::vector<int>& seam, int rowBegin, int rowEnd) {
+    for (int r = rowBegin; r < rowEnd; ++r) {
+        Pixel* row = mat.ptr<Pixel>(r);
+        std::copy(row + seam[r] + 1, row + mat.cols, row + seam[r]);
+    }
+}
+
+/**
+ * @brief Removes the horizontal seam from columns [colBegin, colEnd) within
+ * the matrix's own buffer; afterwards the last row is stale. Rows are swept
+ * top to bottom, so every pixel is read before it is overwritten.
+ */
+template <typename Pixel>
+void removeHorizontalSeamInPlace(cv::Mat& mat, const std::vector<int>& seam, int colBegin, int colEnd) {
+    for (int r = 0; r + 1 < mat.rows; ++r) {
+        Pixel* row = mat.ptr<Pixel>(r);
+        const Pixel* below = mat.ptr<Pixel>(r + 1);
+        for (int c = colBegin; c < colEnd; ++c) {
+            if (r >= seam[c]) row[c] = below[c];
+        }
+    }
+}
+
+/**
+ * @brief Removes a vertical seam from a matrix, replacing it with a new one.
+ */
+template <typename Pixel>
+void removeVerticalSeamFrom(cv::Mat& mat, const std::vector<int>& seam) {
+    cv::Mat result(mat.rows, mat.cols - 1, mat.type());
+    removeVerticalSeamInto<Pixel>(mat, result, seam, 0, mat.rows);
+    mat = result;
+}
+
+/**
+ * @brief Removes a horizontal seam from a matrix, replacing it with a new one.
+ */
+template <typename Pixel>
+void removeHorizontalSeamFrom(cv::Mat& mat, const std::vector<int>& seam) {
+    cv::Mat result(mat.rows - 1, mat.cols, mat.type());
+    removeHorizontalSeamInto<Pixel>(mat, result, seam, 0, mat.rows - 1);
+    mat = result;
+}
+
+/**
+ * @brief Inserts multiple vertical seams into rows [rowBegin, rowEnd) of a matrix.
+ * @tparam Interpolate If true, each inserted pixel is the average of the seam
+ * pixel and its right neighbor; otherwise the seam pixel is duplicated.
+ * @param src The source matrix.
+ * @param dst Preallocated rows x (cols + seams.size()) matrix of the same type.
+ * @param seams The seams to insert (distinct column indices relative to `src`).
+ */
+template <typename Pixel, bool Interpolate = true>
+void addVerticalSeamsInto(const cv::Mat& src, cv::Mat& dst, const std::vector<std::vector<int>>& seams, int rowBegin, int rowEnd) {
+    int cols = src.cols;
+    int numSeams = seams.size();
+    std::vector<int> rowSeamIndices(numSeams);
+
+    for (int r = rowBegin; r < rowEnd; ++r) {
+        // Sort seam indices for this row to process them from left to right
+        for (int i = 0; i < numSeams; ++i) {
+            rowSeamIndices[i] = seams[i][r];
+        }
+        std::sort(rowSeamIndices.begin(), rowSeamIndices.end());
+
+        const Pixel* in = src.ptr<Pixel>(r);
+        Pixel* out = dst.ptr<Pixel>(r);
+        int newCol = 0;
+        int seamIdx = 0;
+
+        for (int oldCol = 0; oldCol < cols; ++oldCol) {
+            // Copy original pixel
+            out[newCol++] = in[oldCol];
+
+            // If this is a seam pixel, add a new pixel
+            while (seamIdx < numSeams && oldCol == rowSeamIndices[seamIdx]) {
+                // Average with right neighbor; at the edge, just duplicate
+                if (Interpolate && oldCol < cols - 1) {
+                    out[newCol++] = averagePixel(in[oldCol], in[oldCol + 1]);
+                } else {
+                    out[newCol++] = in[oldCol];
+                }
+                seamIdx++;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Allocates a matrix like `mat` with the size changed by (dRows, dCols).
+ * @return An empty matrix if `mat` is empty.
+ */
+cv::Mat resizedLike(const cv::Mat& mat, int dRows, int dCols) {
+    if (mat.empty()) {
+        return cv::Mat();
+    }
+    return cv::Mat(mat.rows + dRows, mat.cols + dCols, mat.type());
+}
+
+/**
+ * @brief Creates a CV_32SC2 map where each pixel holds its own (x, y).
+ */
+cv::Mat identityIndexMap(int rows, int cols) {
+    cv::Mat map(rows, cols, CV_32SC2);
+    for (int r = 0; r < rows; ++r) {
+        cv::Vec2i* out = map.ptr<cv::Vec2i>(r);
+        for (int c = 0; c < cols; ++c) {
+            out[c] = cv::Vec2i(c, r);
+        }
+    }
+    return map;
+}
+
+/**
+ * @brief Creates a CV_32S map where each pixel holds its own row index.
+ */
+cv::Mat identityRowMap(int rows, int cols) {
+    cv::Mat map(rows, cols, CV_32S);
+    for (int r = 0; r < rows; ++r) {
+        int* out = map.ptr<int>(r);
+        std::fill(out, out + cols, r);
+    }
+    return map;
+}
+
+/**
+ * @brief Creates a CV_32S map where each pixel holds its own column index.
+ */
+cv::Mat identityColumnMap(int rows, int cols) {
+    cv::Mat map(rows, cols, CV_32S);
+    for (int r = 0; r < rows; ++r) {
+        int* out = map.ptr<int>(r);
+        for (int c = 0; c < cols; ++c) {
+            out[c] = c;
+        }
+    }
+    return map;
+}
+
+// ---
+// Proxy carving helpers (see SeamCarver::setProxyCarving())
+// ---
+
+/**
+ * @brief Start of the full-resolution band for a proxy seam on one line
+ * (row for vertical seams, column for horizontal ones).
+ *
+ * Proxy line r covers lines [r * factor, (r + 1) * factor); the last proxy
+ * line also covers any remainder. Within a block the band moves one pixel
+ * per line towards the next proxy line's position, so it stays connected.
+ * @param seam Proxy seam, in proxy coordinates at the time of its removal.
+ */
+int upsampledSeamStart(const std::vector<int>& seam, int line, int factor) {
+    const int proxyLines = static_cast<int>(seam.size());
+    const int r = std::min(line / factor, proxyLines - 1);
+    const int step = (r + 1 < proxyLines) ? seam[r + 1] - seam[r] : 0;
+    return seam[r] * factor + step * (line - r * factor);
+}
+
+/**
+ * @brief Maps the removals on one line to original indices.
+ *
+ * `positions` holds the index of each removed pixel at the time of its
+ * removal, i.e. on the line as already shrunk by the removals before it.
+ * A Fenwick tree over the surviving pixels finds each one in O(log length).
+ * On return `positions` holds the original indices, sorted.
+ * @param tree Scratch space; resized to length + 1.
+ */
+void originalPositions(int* positions, int count, int length, std::vector<int>& tree) {
+    tree.resize(length + 1);
+    for (int i = 1; i <= length; ++i) {
+        tree[i] = i & -i; // every pixel present
+    }
+    int topBit = 1;
+    while (topBit * 2 <= length) {
+        topBit *= 2;
+    }
+    for (int k = 0; k < count; ++k) {
+        // Find the (positions[k] + 1)-th surviving pixel, then remove it.
+        int remaining = positions[k] + 1;
+        int index = 0;
+        for (int bit = topBit; bit > 0; bit /= 2) {
+            if (index + bit <= length && tree[index + bit] < remaining) {
+                index += bit;
+                remaining -= tree[index];
+            }
+        }
+        positions[k] = index;
+        for (int i = index + 1; i <= length; i += i & -i) {
+            --tree[i];
+        }
+    }
+    std::sort(positions, positions + count);
+}
+
+/**
+ * @brief Copies rows [rowBegin, rowEnd) of `src` into `dst` without the given columns.
+ * Pixels only ever move left, so `dst` may share `src`'s buffer.
+ * @param removed CV_32S, per row the sorted column indices to drop.
+ */
+template <typename Pixel>
+void removeColumnsInto(const cv::Mat& src, cv::Mat& dst, const cv::Mat& removed, int rowBegin, int rowEnd) {
+    for (int r = rowBegin; r < rowEnd; ++r) {
+        const Pixel* in = src.ptr<Pixel>(r);
+        Pixel* out = dst.ptr<Pixel>(r);
+        const int* skip = removed.ptr<int>(r);
+        int from = 0;
+        for (int k = 0; k <= removed.cols; ++k) {
+            const int to = (k < removed.cols) ? skip[k] : src.cols;
+            if (out != in + from) {
+                std::copy(in + from, in + to, out);
+            }
+            out += to - from;
+            from = to + 1;
+        }
+    }
+}
+
+/**
+ * @brief Copies columns [colBegin, colEnd) of `src` into `dst` without the given rows.
+ * Rows are swept top to bottom and pixels only ever move up, so `dst` may
+ * share `src`'s buffer.
+ * @param removed CV_32S, per column the sorted row indices to drop.
+ */
+template <typename Pixel>
+void removeRowsInto(const cv::Mat& src, cv::Mat& dst, const cv::Mat& removed, int colBegin, int colEnd) {
+    std::vector<int> skipped(colEnd - colBegin, 0);
+    for (int r = 0; r < src.rows; ++r) {
+        const Pixel* in = src.ptr<Pixel>(r);
+        for (int c = colBegin; c < colEnd; ++c) {
+            int& k = skipped[c - colBegin];
+            if (k < removed.cols && removed.at<int>(c, k) == r) {
+                ++k;
+            } else {
+                dst.ptr<Pixel>(r - k)[c] = in[c];
+            }
+        }
+    }
+}
+
+} // namespace
+
+int cvTypeFor(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::Gray8: return CV_8UC1;
+        case PixelFormat::BGR8: return CV_8UC3;
+        case PixelFormat::BGRA8: return CV_8UC4;
+        case PixelFormat::Gray16: return CV_16UC1;
+        case PixelFormat::BGR16: return CV_16UC3;
+        case PixelFormat::BGRA16: return CV_16UC4;
+    }
+    throw std::invalid_argument("Unknown pixel format.");
+}
+
+// ---
+// Construction
+// ---
+
+SeamCarver::SeamCarver(const std::string& imagePath, const std::string& protectMaskPath, const std::string& removeMaskPath,
+                       const cv::Size& targetSize) {
+    const int reduction = jpegReductionFor(imagePath, targetSize);
+    m_image = cv::imread(imagePath, reduction > 1 ? reducedColorFlag(reduction) : imreadFlagsFor(imagePath));
+    if (m_image.empty()) {
+        throw std::runtime_error("Could not load input image: " + imagePath);
+    }
+
+    // Load optional masks
+    cv::Mat protectionMask, removalMask;
+    if (!protectMaskPath.empty()) {
+        protectionMask = cv::imread(protectMaskPath, cv::IMREAD_GRAYSCALE);
+        if (protectionMask.empty()) {
+            m_logger.warning([&] { return "Could not load protection mask: " + protectMaskPath; });
+        }
+    }
+
+    if (!removeMaskPath.empty()) {
+        removalMask = cv::imread(removeMaskPath, cv::IMREAD_GRAYSCALE);
+        if (removalMask.empty()) {
+            m_logger.warning([&] { return "Could not load removal mask: " + removeMaskPath; });
+        }
+    }
+
+    // Masks are authored at full resolution.
+    if (reduction > 1) {
+        protectionMask = reduceMask(protectionMask, m_image.size());
+        removalMask = reduceMask(removalMask, m_image.size());
+    }
+
+    validateInput(protectionMask, removalMask);
+    m_logger.info([&] {
+        return "Image loaded: " + std::to_string(m_image.cols) + "x" + std::to_string(m_image.rows) +
+               (reduction > 1 ? " (decoded at 1/" + std::to_string(reduction) + " resolution)" : "");
+    });
+}
+
+SeamCarver::SeamCarver(const cv::Mat& image, const cv::Mat& protectionMask, const cv::Mat& removalMask)
+    : m_image(image) {
+    if (m_image.empty()) {
+        throw std::invalid_argument("Input image is empty.");
+    }
+    validateInput(protectionMask, removalMask);
+}
+
+SeamCarver SeamCarver::fromBuffer(const void* data, int width, int height, size_t stride, PixelFormat format) {
+    if (data == nullptr || width <= 0 || height <= 0) {
+        throw std::invalid_argument("Invalid image buffer.");
+    }
+    // cv::Mat does not take ownership and the carver never writes through this
+    // header. A stride of 0 is cv::Mat::AUTO_STEP (tightly packed rows).
+    cv::Mat wrapped(height, width, cvTypeFor(format), const_cast<void*>(data), stride);
+    return SeamCarver(wrapped);
+}
+
+void SeamCarver::validateInput(const cv::Mat& protectionMask, const cv::Mat& removalMask) {
+    dispatchPixelType(m_image.type(), [](auto) {});
+    setProtectionMask(protectionMask);
+    setRemovalMask(removalMask);
+}
+
+void SeamCarver::setProtectionMask(const cv::Mat& mask) {
+    m_protection = SpanMask::fromMat(conformMask(mask, m_image.size(), "Protection", m_logger));
+}
+
+void SeamCarver::setRemovalMask(const cv::Mat& mask) {
+    m_removal = SpanMask::fromMat(conformMask(mask, m_image.size(), "Removal", m_logger));
+}
+
+void SeamCarver::addMaskShapes(const std::vector<MaskShape>& shapes) {
+    // A mode without shapes leaves its mask absent, so it costs nothing per seam.
+    for (MaskMode mode : {MaskMode::Protect, MaskMode::Remove}) {
+        if (std::none_of(shapes.begin(), shapes.end(), [&](const MaskShape& shape) { return shape.mode == mode; })) {
+            continue;
+        }
+        SpanMask& mask = (mode == MaskMode::Protect) ? m_protection : m_removal;
+        mask.unite(SpanMask::fromShapes(shapes, mode, m_image.size()));
+    }
+}
+
+cv::Mat SeamCarver::protectionMask() const {
+    return m_protection.toMat();
+}
+
+void SeamCarver::setEnergyFunction(EnergyFunction energyFunction) {
+    m_energyFunction = energyFunction;
+}
+
+void SeamCarver::setThreadPool(ThreadPool* pool, int threads) {
+    m_pool = pool;
+    m_threads = (pool != nullptr) ? std::max(1, std::min(threads, pool->size() + 1)) : 1;
+}
+
+void SeamCarver::setLogger(const Logger& logger) {
+    m_logger = logger;
+}
+
+void SeamCarver::setProgressCallback(ProgressCallback callback) {
+    m_progress = std::move(callback);
+}
+
+void SeamCarver::setTimeBudget(std::chrono::milliseconds budget) {
+    m_timeBudgetMs = static_cast<double>(std::max<long long>(0, budget.count()));
+}
+
+void SeamCarver::setHybridCarving(const HybridOptions& options) {
+    if (options.carveFraction > 1.0) {
+        throw std::invalid_argument("Hybrid carve fraction must be at most 1.");
+    }
+    m_hybrid = options;
+}
+
+void SeamCarver::setProxyCarving(int factor) {
+    if (factor < 1) {
+        throw std::invalid_argument("Proxy factor must be at least 1.");
+    }
+    m_proxyFactor = factor;
+}
+
+int SeamCarver::plannedSeams(int delta, int size) const {
+    if (delta >= 0 || !m_hybrid.enabled) {
+        return std::abs(delta);
+    }
+    double carved = (m_hybrid.carveFraction >= 0.0) ? -delta * m_hybrid.carveFraction
+                                                     : std::min<double>(-delta, size * AUTO_HYBRID_CARVE_SHARE);
+    return static_cast<int>(carved);
+}
+
+bool SeamCarver::seamTooExpensive() const {
+    if (!m_hybrid.enabled) {
+        return false;
+    }
+    double limit = (m_hybrid.maxSeamEnergy < 0.0) ? AUTO_HYBRID_MAX_SEAM_ENERGY : m_hybrid.maxSeamEnergy;
+    return limit > 0.0 && m_lastSeamEnergy > limit;
+}
+
+void SeamCarver::setSeamGuide(std::vector<std::vector<int>> seams, int corridor) {
+    if (corridor < 0) {
+        throw std::invalid_argument("Seam guide corridor must be non-negative.");
+    }
+    m_seamGuide = std::move(seams);
+    m_guideCorridor = corridor;
+}
+
+const std::vector<std::vector<int>>& SeamCarver::searchedSeams() const {
+    return m_searchedSeams;
+}
+
+void SeamCarver::setCarveInPlace(bool inPlace) {
+    m_carveInPlace = inPlace;
+}
+
+void SeamCarver::setCancellationToken(const CancellationToken& token) {
+    m_cancellation = token;
+}
+
+void SeamCarver::checkCancelled() const {
+    if (m_cancellation.cancelled()) {
+        throw ResizeCancelled();
+    }
+}
+
+void SeamCarver::reportProgress() const {
+    if (m_progress) {
+        m_progress(static_cast<int>(m_seams.size()), m_seamsTotal);
+    }
+}
+
+void SeamCarver::parallelRows(int rows, const std::function<void(int, int)>& fn) const {
+    const int chunks = std::min(m_threads, rows / MIN_ROWS_PER_THREAD);
+    if (m_pool != nullptr && chunks > 1) {
+        m_pool->parallelFor(rows, chunks, fn);
+    } else {
+        fn(0, rows);
+    }
+}
+
+// ---
+// Resizing
+// ---
+
+ResizeStatus SeamCarver::resize(int newWidth, int newHeight) {
+    if (newWidth < 0 || newHeight < 0) {
+        throw std::invalid_argument("New dimensions must be non-negative.");
+    }
+    if (!m_outputBuffer.empty() && (m_outputBuffer.cols != newWidth || m_outputBuffer.rows != newHeight)) {
+        throw std::invalid_argument("Output buffer size does not match the target dimensions.");
+    }
+
+    int seamsTotal = plannedSeams(newWidth - m_image.cols, m_image.cols) + plannedSeams(newHeight - m_image.rows, m_image.rows);
+    return runCarving(seamsTotal, [&](auto policy) { resizeWith<decltype(policy)>(newWidth, newHeight); });
+}
+
+ResizeStatus SeamCarver::removeObject(bool restoreSize) {
+    cv::Rect bounds = removalBounds();
+    if (bounds.empty()) {
+        throw std::invalid_argument("Object removal requires a non-empty removal mask.");
+    }
+    const int originalWidth = m_image.cols;
+    const int originalHeight = m_image.rows;
+    if (!m_outputBuffer.empty() &&
+        (!restoreSize || m_outputBuffer.cols != originalWidth || m_outputBuffer.rows != originalHeight)) {
+        throw std::invalid_argument("Object removal can only write into an output buffer of the original size, with restoreSize.");
+    }
+
+    // Narrow objects go with fewer vertical seams, wide ones with horizontal seams.
+    const SeamDirection direction = (bounds.width <= bounds.height) ? SeamDirection::Vertical : SeamDirection::Horizontal;
+    int seamsTotal = (direction == SeamDirection::Vertical) ? bounds.width : bounds.height;
+    if (restoreSize) {
+        seamsTotal *= 2;
+    }
+    return runCarving(seamsTotal, [&](auto policy) {
+        removeObjectWith<decltype(policy)>(direction, originalWidth, originalHeight, restoreSize);
+    });
+}
+
+ResizeStatus SeamCarver::applySeams(const std::vector<SeamRecord>& seams, int newWidth, int newHeight,
+                                    const std::vector<ScaleRecord>& scales) {
+    if (newWidth <= 0 || newHeight <= 0) {
+        throw std::invalid_argument("New dimensions must be positive.");
+    }
+    if (!m_outputBuffer.empty() && (m_outputBuffer.cols != newWidth || m_outputBuffer.rows != newHeight)) {
+        throw std::invalid_argument("Output buffer size does not match the target dimensions.");
+    }
+    // The energy policy is irrelevant to a replay; runCarving() only supplies the bookkeeping.
+    return runCarving(static_cast<int>(seams.size()), [&](auto) { replaySeams(seams, newWidth, newHeight, scales); });
+}
+
+template <typename Job>
+ResizeStatus SeamCarver::runCarving(int seamsTotal, Job&& job) {
+    auto start = std::chrono::steady_clock::now();
+    m_resizeStart = start;
+    m_reuseEnergy = false;
+    m_seams.clear();
+    m_scales.clear();
+    m_searchedSeams.clear();
+    m_stats = ResizeStats();
+    m_stats.inputWidth = m_image.cols;
+    m_stats.inputHeight = m_image.rows;
+    m_seamsTotal = seamsTotal;
+    if (m_trackIndexMap) {
+        m_indexMap = identityIndexMap(m_image.rows, m_image.cols);
+    }
+
+    // Dispatch once; everything below runs fully specialized per policy.
+    ResizeStatus status = ResizeStatus::Completed;
+    try {
+        switch (m_energyFunction) {
+            case EnergyFunction::Sobel3: job(Sobel3Energy()); break;
+            case EnergyFunction::Sobel5: job(Sobel5Energy()); break;
+            case EnergyFunction::Scharr: job(ScharrEnergy()); break;
+            case EnergyFunction::DualGradient: job(DualGradientEnergy()); break;
+            case EnergyFunction::RGBGradient: job(RGBGradientEnergy()); break;
+            case EnergyFunction::Entropy: job(EntropyEnergy()); break;
+            case EnergyFunction::Saliency: job(SaliencyEnergy()); break;
+        }
+    } catch (const ResizeCancelled&) {
+        status = ResizeStatus::Cancelled;
+    }
+
+    // The final carving step normally writes straight into the output buffer;
+    // copy only when it could not (no-op resize, horizontal insertion).
+    if (status == ResizeStatus::Completed && !m_outputBuffer.empty() && m_image.data != m_outputBuffer.data) {
+        m_image.copyTo(m_outputBuffer);
+        m_image = m_outputBuffer;
+    }
+
+    m_stats.outputWidth = m_image.cols;
+    m_stats.outputHeight = m_image.rows;
+    for (const SeamRecord& seam : m_seams) {
+        ++(seam.inserted ? m_stats.seamsInserted : m_stats.seamsRemoved);
+    }
+    m_stats.cancelled = (status == ResizeStatus::Cancelled);
+    m_stats.totalMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    m_logger.info([&] {
+        return std::string(status == ResizeStatus::Completed ? "Resize complete." : "Resize cancelled.") +
+               " New dimensions: " + std::to_string(m_image.cols) + "x" + std::to_string(m_image.rows);
+    });
+    return status;
+}
+
+template <typename EnergyPolicy>
+void SeamCarver::resizeWith(int newWidth, int newHeight) {
+    m_stats.energyFunction = EnergyPolicy::name();
+    int currentWidth = m_image.cols;
+    int currentHeight = m_image.rows;
+
+    // --- 1. Width Resizing ---
+    // With a time budget or in hybrid mode, carving may stop short; the rest
+    // of the delta is scaled.
+    int deltaCols = newWidth - currentWidth;
+    if (deltaCols < 0) {
+        m_logger.info([&] { return "Reducing width by " + std::to_string(-deltaCols) + " pixels..."; });
+        removeSeamsViaProxy<EnergyPolicy>(SeamDirection::Vertical, plannedSeams(deltaCols, currentWidth));
+        if (m_image.cols > newWidth) {
+            scaleTo(newWidth, m_image.rows);
+        }
+    } else if (deltaCols > 0) {
+        m_logger.info([&] { return "Expanding width by " + std::to_string(deltaCols) + " pixels..."; });
+        std::vector<std::vector<int>> seams = findInsertionSeams<EnergyPolicy>(SeamDirection::Vertical, deltaCols);
+        {
+            PhaseTimer timer(m_stats.insertion);
+            addVerticalSeams(seams);
+        }
+        if (m_image.cols < newWidth) {
+            scaleTo(newWidth, m_image.rows);
+        }
+    }
+
+    // --- 2. Height Resizing ---
+    int deltaRows = newHeight - currentHeight;
+    if (deltaRows < 0) {
+        m_logger.info([&] { return "Reducing height by " + std::to_string(-deltaRows) + " pixels..."; });
+        removeSeamsViaProxy<EnergyPolicy>(SeamDirection::Horizontal, plannedSeams(deltaRows, currentHeight));
+        if (m_image.rows > newHeight) {
+            scaleTo(m_image.cols, newHeight);
+        }
+    } else if (deltaRows > 0) {
+        m_logger.info([&] { return "Expanding height by " + std::to_string(deltaRows) + " pixels..."; });
+        std::vector<std::vector<int>> seams = findInsertionSeams<EnergyPolicy>(SeamDirection::Horizontal, deltaRows);
+        {
+            PhaseTimer timer(m_stats.insertion);
+            addHorizontalSeams(seams);
+        }
+        if (m_image.rows < newHeight) {
+            scaleTo(m_image.cols, newHeight);
+        }
+    }
+}
+
+void SeamCarver::replaySeams(const std::vector<SeamRecord>& seams, int newWidth, int newHeight,
+                             const std::vector<ScaleRecord>& scales) {
+    m_stats.energyFunction = "replay";
+    m_logger.info([&] { return "Replaying " + std::to_string(seams.size()) + " seams..."; });
+
+    // Recorded scaling steps run before the seam at their position.
+    size_t nextScale = 0;
+    auto scaleUpTo = [&](size_t position) {
+        for (; nextScale < scales.size() && scales[nextScale].position <= position; ++nextScale) {
+            const ScaleRecord& step = scales[nextScale];
+            if (step.width <= 0 || step.height <= 0) {
+                throw std::invalid_argument("Scaling step " + std::to_string(nextScale) + " has an invalid size.");
+            }
+            scaleTo(step.width, step.height);
+        }
+    };
+
+    for (size_t i = 0; i < seams.size();) {
+        checkCancelled();
+        scaleUpTo(i);
+        const SeamRecord& record = seams[i];
+        const bool vertical = (record.direction == SeamDirection::Vertical);
+        const int length = static_cast<int>(record.indices.size());
+
+        // Without recorded steps: resize() scales the rest of a dimension it
+        // stopped carving short of (possibly all of it) before it starts on
+        // the other one, so the seam length shows the size.
+        if (length != (vertical ? m_image.rows : m_image.cols)) {
+            if (!scales.empty() || length <= 0 || (i > 0 && seams[i - 1].direction == record.direction)) {
+                throw std::invalid_argument("Seam " + std::to_string(i) + " does not fit the image.");
+            }
+            if (vertical) {
+                scaleTo(m_image.cols, length);
+            } else {
+                scaleTo(length, m_image.rows);
+            }
+        }
+
+        // A run of insertions was one batch, in the coordinates of the image before it.
+        size_t end = i + 1;
+        while (record.inserted && end < seams.size() && seams[end].inserted && seams[end].direction == record.direction) {
+            ++end;
+        }
+        const int extent = vertical ? m_image.cols : m_image.rows;
+        for (size_t k = i; k < end; ++k) {
+            const std::vector<int>& indices = seams[k].indices;
+            bool fits = static_cast<int>(indices.size()) == length &&
+                        std::all_of(indices.begin(), indices.end(), [extent](int index) { return index >= 0 && index < extent; });
+            if (!fits) {
+                throw std::invalid_argument("Seam " + std::to_string(k) + " does not fit the image.");
+            }
+        }
+
+        if (record.inserted) {
+            std::vector<std::vector<int>> batch;
+            batch.reserve(end - i);
+            for (size_t k = i; k < end; ++k) {
+                batch.push_back(seams[k].indices);
+            }
+            PhaseTimer timer(m_stats.insertion);
+            if (vertical) {
+                addVerticalSeams(batch);
+            } else {
+                addHorizontalSeams(batch);
+            }
+        } else if (vertical) {
+            removeVerticalSeam(record.indices);
+        } else {
+            removeHorizontalSeam(record.indices);
+        }
+        for (; i < end; ++i) {
+            m_seams.push_back(seams[i]);
+            reportProgress();
+        }
+    }
+
+    scaleUpTo(seams.size());
+    if (m_image.cols != newWidth || m_image.rows != newHeight) {
+        scaleTo(newWidth, newHeight);
+    }
+}
+
+template <typename EnergyPolicy>
+void SeamCarver::removeObjectWith(SeamDirection direction, int originalWidth, int originalHeight, bool restoreSize) {
+    m_stats.energyFunction = EnergyPolicy::name();
+    const bool vertical = (direction == SeamDirection::Vertical);
+    m_logger.info([&] { return std::string("Removing object with ") + (vertical ? "vertical" : "horizontal") + " seams..."; });
+
+    // Keep at least one column (row); the loop normally ends long before.
+    int removed = removeSeams<EnergyPolicy>(direction, (vertical ? m_image.cols : m_image.rows) - 1, true);
+    if (!removalBounds().empty()) {
+        m_logger.warning([] { return std::string("Part of the object is unreachable without crossing protected regions."); });
+    }
+    m_logger.info([&] { return "Object removed with " + std::to_string(removed) + " seams."; });
+
+    if (restoreSize) {
+        m_seamsTotal = 2 * removed;
+        resizeWith<EnergyPolicy>(originalWidth, originalHeight);
+    }
+}
+
+template <typename EnergyPolicy>
+int SeamCarver::removeSeams(SeamDirection direction, int count, bool untilObjectGone) {
+    const bool vertical = (direction == SeamDirection::Vertical);
+    int carvedSinceEnergy = std::numeric_limits<int>::max();
+    for (int i = 0; i < count; ++i) {
+        checkCancelled();
+        if (untilObjectGone && removalBounds().empty()) {
+            return i;
+        }
+        int interval = energyInterval();
+        if (interval == 0) {
+            return i;
+        }
+        refreshEnergy<EnergyPolicy>(carvedSinceEnergy, interval);
+
+        std::vector<int> seam = vertical ? findVerticalSeam() : findHorizontalSeam();
+        m_searchedSeams.push_back(seam);
+        // A non-negative seam crosses no more removal than protected pixels.
+        if (seamTooExpensive() || (untilObjectGone && m_lastSeamEnergy >= 0.0)) {
+            return i;
+        }
+        if (vertical) {
+            removeVerticalSeam(seam);
+        } else {
+            removeHorizontalSeam(seam);
+        }
+        ++carvedSinceEnergy;
+        m_seams.push_back({direction, false, std::move(seam)});
+        reportProgress();
+    }
+    return count;
+}
+
+template <typename EnergyPolicy>
+int SeamCarver::removeSeamsViaProxy(SeamDirection direction, int count) {
+    const bool vertical = (direction == SeamDirection::Vertical);
+    const int factor = m_proxyFactor;
+    const cv::Size proxySize(m_image.cols / factor, m_image.rows / factor);
+    const int bands = (count + factor - 1) / factor;
+    // The proxy must keep a column (row) and enough lines to be worth searching.
+    if (factor == 1 || count == 0 || std::min(proxySize.width, proxySize.height) < MIN_PROXY_SIZE ||
+        bands >= (vertical ? proxySize.width : proxySize.height)) {
+        return removeSeams<EnergyPolicy>(direction, count);
+    }
+
+    // 1. Search the proxy. It shares the cancellation token, pool, hybrid
+    // limits and time budget (with the same start, so only the remaining time
+    // is left), so a hybrid or budgeted carve may stop short there as well.
+    // Progress counts each proxy seam as the band of seams it stands for.
+    const int lines = vertical ? m_image.rows : m_image.cols;
+    const int extent = vertical ? m_image.cols : m_image.rows;
+    std::vector<SeamRecord> proxySeams;
+    cv::Mat removed;
+    {
+        PhaseTimer timer(m_stats.proxy);
+        cv::Mat proxy;
+        cv::resize(m_image, proxy, proxySize, 0, 0, cv::INTER_AREA);
+        m_stats.proxy.pixelsTouched += static_cast<long long>(m_image.total());
+        m_stats.proxy.bytesAllocated += matBytes(proxy);
+
+        SeamCarver proxyCarver(proxy);
+        proxyCarver.m_protection = m_protection.reduced(proxySize);
+        proxyCarver.m_removal = m_removal.reduced(proxySize);
+        proxyCarver.m_logger = m_logger;
+        proxyCarver.m_pool = m_pool;
+        proxyCarver.m_threads = m_threads;
+        proxyCarver.m_cancellation = m_cancellation;
+        proxyCarver.m_hybrid = m_hybrid;
+        proxyCarver.m_timeBudgetMs = m_timeBudgetMs;
+        proxyCarver.m_resizeStart = m_resizeStart;
+        proxyCarver.m_seamsTotal = bands;
+        if (m_progress) {
+            const int done = static_cast<int>(m_seams.size());
+            const int total = m_seamsTotal;
+            ProgressCallback progress = m_progress;
+            proxyCarver.m_progress = [=](int bandsDone, int) { progress(done + std::min(count, bandsDone * factor), total); };
+        }
+        proxyCarver.removeSeams<EnergyPolicy>(direction, bands);
+        proxySeams = std::move(proxyCarver.m_seams);
+        m_lastSeamEnergy = proxyCarver.m_lastSeamEnergy;
+
+        // 2. Widen each proxy seam into a band (the last one may be narrower)
+        // and find the original indices of all of them, line by line.
+        const int total = std::min(count, static_cast<int>(proxySeams.size()) * factor);
+        removed.create(lines, total, CV_32S);
+        m_stats.proxy.bytesAllocated += matBytes(removed);
+        parallelRows(lines, [&](int begin, int end) {
+            std::vector<int> tree;
+            for (int line = begin; line < end; ++line) {
+                int* positions = removed.ptr<int>(line);
+                for (int k = 0; k < total; ++k) {
+                    positions[k] = upsampledSeamStart(proxySeams[k / factor].indices, line, factor);
+                }
+                originalPositions(positions, total, extent, tree);
+            }
+        });
+    }
+
+    // 3. Record every full-resolution seam (in the coordinates of its own
+    // removal, as removeSeams() does), then compact once.
+    const int total = removed.cols;
+    std::vector<int> seam(lines);
+    for (int k = 0; k < total; ++k) {
+        if (k % factor == 0) {
+            for (int line = 0; line < lines; ++line) {
+                seam[line] = upsampledSeamStart(proxySeams[k / factor].indices, line, factor);
+            }
+        }
+        m_seams.push_back({direction, false, seam});
+    }
+    removeSeamSet(direction, removed);
+    m_stats.proxySeams += static_cast<int>(proxySeams.size());
+    m_logger.debug([&] {
+        return "Removed " + std::to_string(total) + " seams found on a " + std::to_string(proxySize.width) + "x" +
+               std::to_string(proxySize.height) + " proxy.";
+    });
+    reportProgress();
+    return total;
+}
+
+template <typename EnergyPolicy>
+void SeamCarver::refreshEnergy(int& carvedSinceEnergy, int interval) {
+    // Removal compacts the energy map alongside the image only while it will be reused.
+    m_reuseEnergy = (interval > 1);
+    m_stats.maxEnergyInterval = std::max(m_stats.maxEnergyInterval, interval);
+    if (carvedSinceEnergy >= interval || m_energyMap.size() != m_image.size()) {
+        calculateEnergy<EnergyPolicy>();
+        carvedSinceEnergy = 0;
+    }
+}
+
+int SeamCarver::energyInterval() const {
+    if (m_timeBudgetMs <= 0.0) {
+        return 1;
+    }
+    double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_resizeStart).count();
+    double remaining = m_timeBudgetMs * (1.0 - SCALE_RESERVE_FRACTION) - elapsed;
+    long long seamsMeasured = m_stats.verticalSearch.calls + m_stats.horizontalSearch.calls;
+    if (m_stats.energy.calls == 0 || seamsMeasured == 0) {
+        // Nothing measured yet: carve one exact seam to calibrate.
+        return remaining > 0.0 ? 1 : 0;
+    }
+
+    double energyCost = m_stats.energy.milliseconds / m_stats.energy.calls;
+    double seamCost = (m_stats.verticalSearch.milliseconds + m_stats.horizontalSearch.milliseconds +
+                       m_stats.removal.milliseconds) / seamsMeasured;
+    double seamsLeft = m_seamsTotal - static_cast<double>(m_seams.size()) - m_stats.seamsScaled;
+    for (int interval = 1; interval <= MAX_ENERGY_INTERVAL; interval *= 2) {
+        if (seamsLeft * (energyCost / interval + seamCost) <= remaining) {
+            return interval;
+        }
+    }
+    // Even the cheapest carving does not fit: keep carving while a seam
+    // still does, and leave the rest to the scaling fallback.
+    return (remaining >= energyCost + seamCost) ? MAX_ENERGY_INTERVAL : 0;
+}
+
+void SeamCarver::scaleTo(int cols, int rows) {
+    PhaseTimer timer(m_stats.scaling);
+    const int delta = std::abs(cols - m_image.cols) + std::abs(rows - m_image.rows);
+    m_logger.info([&] { return "Scaling the remaining " + std::to_string(delta) + " pixels..."; });
+
+    const bool shrinking = cols * rows < m_image.cols * m_image.rows;
+    cv::Mat result = allocateImage(rows, cols);
+    cv::resize(m_image, result, result.size(), 0, 0, shrinking ? cv::INTER_AREA : cv::INTER_LINEAR);
+
+    // Masks and source coordinates must not be blended.
+    cv::Mat index;
+    if (!m_indexMap.empty()) cv::resize(m_indexMap, index, result.size(), 0, 0, cv::INTER_NEAREST);
+    countAllocation(m_stats.scaling, result, {&index});
+
+    m_scales.push_back({m_seams.size(), cols, rows});
+    m_image = result;
+    m_protection = m_protection.resized(result.size());
+    m_removal = m_removal.resized(result.size());
+    m_indexMap = index;
+    m_stats.seamsScaled += delta;
+}
+
+template <typename EnergyPolicy>
+std::vector<std::vector<int>> SeamCarver::findInsertionSeams(SeamDirection direction, int count) {
+    const bool vertical = (direction == SeamDirection::Vertical);
+    if (count > (vertical ? m_image.cols : m_image.rows)) {
+        throw std::invalid_argument("Cannot insert more seams than the image has columns/rows in one pass.");
+    }
+
+    // For expansion, we find all seams at once on the original image
+    // to avoid repeatedly adding seams in the same low-energy area.
+    cv::Mat originalImage = m_image;
+    SpanMask originalProtection = m_protection;
+    SpanMask originalRemoval = m_removal;
+    cv::Mat originalIndexMap = m_indexMap;
+    // The search removes seams only to find the next one; carving in place
+    // would overwrite the pixels the seams are then inserted into.
+    const bool carveInPlace = m_carveInPlace;
+    m_carveInPlace = false;
+
+    // Tracks which original column (or row) each remaining pixel came from,
+    // so seams found on the shrinking image map back to original coordinates.
+    cv::Mat origin = vertical ? identityColumnMap(m_image.rows, m_image.cols)
+                              : identityRowMap(m_image.rows, m_image.cols);
+
+    std::vector<std::vector<int>> seams;
+    seams.reserve(count);
+    const size_t recordedSeams = m_seams.size();
+    int carvedSinceEnergy = std::numeric_limits<int>::max();
+    try {
+        for (int i = 0; i < count; ++i) {
+            checkCancelled();
+            int interval = energyInterval();
+            if (interval == 0) {
+                break;
+            }
+            refreshEnergy<EnergyPolicy>(carvedSinceEnergy, interval);
+            ++carvedSinceEnergy;
+            std::vector<int> seam = vertical ? findVerticalSeam() : findHorizontalSeam();
+            m_searchedSeams.push_back(seam);
+
+            std::vector<int> originalSeam(seam.size());
+            for (size_t k = 0; k < seam.size(); ++k) {
+                originalSeam[k] = vertical ? origin.at<int>(k, seam[k]) : origin.at<int>(seam[k], k);
+            }
+            seams.push_back(originalSeam);
+            m_seams.push_back({direction, true, std::move(originalSeam)});
+            reportProgress();
+
+            // Temporarily remove seam to find the *next* best seam
+            if (vertical) {
+                removeVerticalSeam(seam);
+                removeVerticalSeamFrom<int>(origin, seam);
+            } else {
+                removeHorizontalSeam(seam);
+                removeHorizontalSeamFrom<int>(origin, seam);
+            }
+        }
+    } catch (const ResizeCancelled&) {
+        // None of these seams were inserted: roll back to the pre-search state.
+        m_image = originalImage;
+        m_protection = originalProtection;
+        m_removal = originalRemoval;
+        m_indexMap = originalIndexMap;
+        m_carveInPlace = carveInPlace;
+        m_seams.resize(recordedSeams);
+        throw;
+    }
+
+    // Restore original image (and masks) for insertion
+    m_image = originalImage;
+    m_protection = std::move(originalProtection);
+    m_removal = std::move(originalRemoval);
+    m_indexMap = originalIndexMap;
+    m_carveInPlace = carveInPlace;
+    return seams;
+}
+
+template <typename EnergyPolicy>
+void SeamCarver::calculateEnergy() {
+    PhaseTimer timer(m_stats.energy);
+    m_stats.energy.pixelsTouched += static_cast<long long>(m_image.total());
+
+    // 1. Compute the 0-255 normalized energy map. Policies write into the map's
+    // buffer when it fits, so only count the bytes when it was (re)allocated.
+    const uchar* previous = m_energyMap.data;
+    EnergyPolicy::compute(m_image, m_energyMap);
+    if (m_energyMap.data != previous) {
+        m_stats.energy.bytesAllocated += matBytes(m_energyMap);
+    }
+
+    // 2. Apply masks: protected runs get max energy, removal runs min energy
+    // (removal wins where both overlap). Only masked pixels are visited.
+    if (m_protection.empty() && m_removal.empty()) {
+        return;
+    }
+    parallelRows(m_image.rows, [&](int begin, int end) {
+        m_protection.fill(m_energyMap, MAX_ENERGY, begin, end);
+        m_removal.fill(m_energyMap, MIN_ENERGY, begin, end);
+    });
+}
+
+// ---
+// Seam search
+// ---
+
+std::vector<int> SeamCarver::findVerticalSeam() {
+    PhaseTimer timer(m_stats.verticalSearch);
+    const std::vector<int>* guide = seamGuide(m_energyMap.rows);
+    return traceVerticalSeam(m_stats.verticalSearch, guide ? cv::Rect() : removalBounds(), guide);
+}
+
+cv::Rect SeamCarver::removalBounds() const {
+    return m_removal.bounds();
+}
+
+const std::vector<int>* SeamCarver::seamGuide(int length) const {
+    size_t step = m_searchedSeams.size();
+    if (step < m_seamGuide.size() && static_cast<int>(m_seamGuide[step].size()) == length) {
+        return &m_seamGuide[step];
+    }
+    return nullptr;
+}
+
+std::vector<int> SeamCarver::traceVerticalSeam(PhaseStats& stats, const cv::Rect& removal, const std::vector<int>* guide) {
+    int rows = m_energyMap.rows;
+    int cols = m_energyMap.cols;
+    std::vector<int> seam(rows);
+
+    // Columns [lo, hi] of row r that the DP fills. A guided search stays in
+    // the corridor around its guide seam. Otherwise, a seam moves at most one
+    // column per row, so one through the removal region stays within its
+    // bounding box widened by the row distance to it.
+    const bool banded = !removal.empty();
+    auto bandLo = [&](int r) {
+        if (guide != nullptr) return std::max(0, std::min((*guide)[r], cols - 1) - m_guideCorridor);
+        if (!banded) return 0;
+        int drift = std::max(removal.y - r, r - (removal.y + removal.height - 1));
+        return std::max(0, removal.x - std::max(drift, 0));
+    };
+    auto bandHi = [&](int r) {
+        if (guide != nullptr) return std::min(cols - 1, std::max((*guide)[r], 0) + m_guideCorridor);
+        if (!banded) return cols - 1;
+        int drift = std::max(removal.y - r, r - (removal.y + removal.height - 1));
+        return std::min(cols - 1, removal.x + removal.width - 1 + std::max(drift, 0));
+    };
+
+    // DP costs: only the previous and the current row are ever needed
+    cv::Mat dpCost = cv::Mat(2, cols, CV_64F);
+
+    // Parent steps (-1, 0, +1 column) to reconstruct the path; one byte per
+    // pixel keeps the DP working set small on very large images.
+    cv::Mat parent = cv::Mat(rows, cols, CV_8S);
+    stats.bytesAllocated += matBytes(dpCost) + matBytes(parent);
+
+    // 1. Initialize first row
+    int lo = bandLo(0);
+    int hi = bandHi(0);
+    std::copy(m_energyMap.ptr<double>(0) + lo, m_energyMap.ptr<double>(0) + hi + 1, dpCost.ptr<double>(0) + lo);
+    stats.pixelsTouched += hi - lo + 1;
+
+    // Columns [reachLo, reachHi] of the previous row that a seam from the
+    // first row can reach. A proxy or replayed guide may jump several columns
+    // between rows, so its corridor is widened wherever it would lose touch
+    // with them; otherwise no path would connect the first and last rows.
+    int reachLo = lo;
+    int reachHi = hi;
+
+    // 2. Fill DP table. Columns within a row are independent, so wide
+    // images split each row across threads.
+    for (int r = 1; r < rows; ++r) {
+        if (r % CANCELLATION_CHECK_ROWS == 0) {
+            checkCancelled();
+        }
+        const int prevLo = lo;
+        const int prevHi = hi;
+        lo = std::min(bandLo(r), reachHi + 1);
+        hi = std::max(bandHi(r), reachLo - 1);
+        reachLo = std::max(lo, reachLo - 1);
+        reachHi = std::min(hi, reachHi + 1);
+        stats.pixelsTouched += hi - lo + 1;
+
+        const double* prev = dpCost.ptr<double>((r - 1) % 2);
+        const double* energy = m_energyMap.ptr<double>(r);
+        double* cost = dpCost.ptr<double>(r % 2);
+        schar* from = parent.ptr<schar>(r);
+
+        auto fillColumns = [&](int begin, int end) {
+            for (int c = begin; c < end; ++c) {
+                double left = (c - 1 >= prevLo && c - 1 <= prevHi) ? prev[c - 1] : std::numeric_limits<double>::max();
+                double middle = (c >= prevLo && c <= prevHi) ? prev[c] : std::numeric_limits<double>::max();
+                double right = (c + 1 >= prevLo && c + 1 <= prevHi) ? prev[c + 1] : std::numeric_limits<double>::max();
+
+                double minVal = middle;
+                schar step = 0;
+
+                if (left < minVal) {
+                    minVal = left;
+                    step = -1;
+                }
+                if (right < minVal) {
+                    minVal = right;
+                    step = 1;
+                }
+
+                cost[c] = energy[c] + minVal;
+                from[c] = step;
+            }
+        };
+
+        const int width = hi - lo + 1;
+        const int dpChunks = std::min(m_threads, width / MIN_DP_COLUMNS_PER_THREAD);
+        if (m_pool != nullptr && dpChunks > 1) {
+            m_pool->parallelFor(width, dpChunks, [&](int begin, int end) { fillColumns(lo + begin, lo + end); });
+        } else {
+            fillColumns(lo, hi + 1);
+        }
+    }
+
+    // 3. Find minimum cost in the last row
+    const double* lastRow = dpCost.ptr<double>((rows - 1) % 2);
+    double minVal = std::numeric_limits<double>::max();
+    int minIdx = lo;
+    for (int c = lo; c <= hi; ++c) {
+        if (lastRow[c] < minVal) {
+            minVal = lastRow[c];
+            minIdx = c;
+        }
+    }
+
+    // Energies outside the removal mask are non-negative, so every seam the
+    // band excluded costs at least 0. A negative optimum is therefore global.
+    if (guide != nullptr) {
+        ++m_stats.guidedSearches;
+    } else if (banded) {
+        ++m_stats.roiSearches;
+        if (minVal >= 0.0) {
+            ++m_stats.roiFallbacks;
+            m_logger.debug([] { return std::string("Removal seam blocked; searching the full image."); });
+            return traceVerticalSeam(stats);
+        }
+    }
+
+    m_lastSeamEnergy = minVal / rows;
+
+    // 4. Backtrack to find the seam
+    seam[rows - 1] = minIdx;
+    for (int r = rows - 2; r >= 0; --r) {
+        seam[r] = seam[r + 1] + parent.at<schar>(r + 1, seam[r + 1]);
+    }
+
+    return seam;
+}
+
+std::vector<int> SeamCarver::findHorizontalSeam() {
+    PhaseTimer timer(m_stats.horizontalSearch);
+
+    // --- Transpose Method ---
+    // The DP only reads the energy map, so only it needs transposing.
+    cv::Mat originalEnergy = m_energyMap;
+    m_energyMap = m_energyMap.t();
+    m_stats.horizontalSearch.bytesAllocated += matBytes(m_energyMap);
+
+    // Find a *vertical* seam on the transposed energy (and removal region)
+    const std::vector<int>* guide = seamGuide(m_energyMap.rows);
+    cv::Rect removal = guide ? cv::Rect() : removalBounds();
+    std::vector<int> seam = traceVerticalSeam(m_stats.horizontalSearch,
+                                              cv::Rect(removal.y, removal.x, removal.height, removal.width), guide);
+
+    // Restore original (non-transposed) energy
+    m_energyMap = originalEnergy;
+
+    return seam;
+}
+
+// ---
+// Seam removal and insertion
+// ---
+
+void SeamCarver::countAllocation(PhaseStats& stats, const cv::Mat& image, std::initializer_list<const cv::Mat*> others) const {
+    stats.pixelsTouched += static_cast<long long>(m_image.total());
+    // Writing in place or into the caller's output buffer allocates nothing.
+    if (image.data != m_outputBuffer.data && image.data != m_image.data) {
+        stats.bytesAllocated += matBytes(image);
+    }
+    for (const cv::Mat* mat : others) {
+        stats.bytesAllocated += matBytes(*mat);
+    }
+}
+
+cv::Mat SeamCarver::allocateImage(int rows, int cols) const {
+    // Only the final carving step produces an image of the target size, so
+    // that step writes straight into the caller's buffer.
+    if (!m_outputBuffer.empty() && m_outputBuffer.rows == rows && m_outputBuffer.cols == cols) {
+        return m_outputBuffer;
+    }
+    return cv::Mat(rows, cols, m_image.type());
+}
+
+void SeamCarver::removeVerticalSeam(const std::vector<int>& seam) {
+    PhaseTimer timer(m_stats.removal);
+    cv::Mat result = m_carveInPlace ? m_image.colRange(0, m_image.cols - 1) : allocateImage(m_image.rows, m_image.cols - 1);
+    cv::Mat index = resizedLike(m_indexMap, 0, -1);
+    cv::Mat energy = (m_reuseEnergy && m_energyMap.size() == m_image.size()) ? resizedLike(m_energyMap, 0, -1) : cv::Mat();
+    countAllocation(m_stats.removal, result, {&index, &energy});
+
+    // Image and index map are compacted in one pass over each row band; the
+    // masks only move their run endpoints.
+    parallelRows(m_image.rows, [&](int begin, int end) {
+        dispatchPixelType(m_image.type(), [&](auto pixel) {
+            if (m_carveInPlace) {
+                removeVerticalSeamInPlace<decltype(pixel)>(m_image, seam, begin, end);
+            } else {
+                removeVerticalSeamInto<decltype(pixel)>(m_image, result, seam, begin, end);
+            }
+        });
+        if (!index.empty()) removeVerticalSeamInto<cv::Vec2i>(m_indexMap, index, seam, begin, end);
+        if (!energy.empty()) removeVerticalSeamInto<double>(m_energyMap, energy, seam, begin, end);
+    });
+
+    m_protection.removeVerticalSeam(seam);
+    m_removal.removeVerticalSeam(seam);
+
+    m_image = result;
+    m_indexMap = index;
+    if (!energy.empty()) m_energyMap = energy;
+}
+
+void SeamCarver::removeHorizontalSeam(const std::vector<int>& seam) {
+    PhaseTimer timer(m_stats.removal);
+    cv::Mat result = m_carveInPlace ? m_image.rowRange(0, m_image.rows - 1) : allocateImage(m_image.rows - 1, m_image.cols);
+    cv::Mat index = resizedLike(m_indexMap, -1, 0);
+    cv::Mat energy = (m_reuseEnergy && m_energyMap.size() == m_image.size()) ? resizedLike(m_energyMap, -1, 0) : cv::Mat();
+    countAllocation(m_stats.removal, result, {&index, &energy});
+
+    // In place, each output row depends on the next input row, so the image
+    // is split into column bands instead of row bands.
+    if (m_carveInPlace) {
+        parallelRows(m_image.cols, [&](int begin, int end) {
+            dispatchPixelType(m_image.type(), [&](auto pixel) {
+                removeHorizontalSeamInPlace<decltype(pixel)>(m_image, seam, begin, end);
+            });
+        });
+    }
+    parallelRows(m_image.rows - 1, [&](int begin, int end) {
+        if (!m_carveInPlace) {
+            dispatchPixelType(m_image.type(), [&](auto pixel) {
+                removeHorizontalSeamInto<decltype(pixel)>(m_image, result, seam, begin, end);
+            });
+        }
+        if (!index.empty()) removeHorizontalSeamInto<cv::Vec2i>(m_indexMap, index, seam, begin, end);
+        if (!energy.empty()) removeHorizontalSeamInto<double>(m_energyMap, energy, seam, begin, end);
+    });
+
+    m_protection.removeHorizontalSeam(seam);
+    m_removal.removeHorizontalSeam(seam);
+
+    m_image = result;
+    m_indexMap = index;
+    if (!energy.empty()) m_energyMap = energy;
+}
+
+void SeamCarver::removeSeamSet(SeamDirection direction, const cv::Mat& removed) {
+    PhaseTimer timer(m_stats.removal);
+    const bool vertical = (direction == SeamDirection::Vertical);
+    const int dRows = vertical ? 0 : -removed.cols;
+    const int dCols = vertical ? -removed.cols : 0;
+    cv::Mat result = m_carveInPlace ? m_image(cv::Rect(0, 0, m_image.cols + dCols, m_image.rows + dRows))
+                                    : allocateImage(m_image.rows + dRows, m_image.cols + dCols);
+    cv::Mat index = resizedLike(m_indexMap, dRows, dCols);
+    countAllocation(m_stats.removal, result, {&index});
+
+    // Vertical sets split into row bands, horizontal ones into column bands.
+    parallelRows(vertical ? m_image.rows : m_image.cols, [&](int begin, int end) {
+        if (vertical) {
+            dispatchPixelType(m_image.type(), [&](auto pixel) {
+                removeColumnsInto<decltype(pixel)>(m_image, result, removed, begin, end);
+            });
+            if (!index.empty()) removeColumnsInto<cv::Vec2i>(m_indexMap, index, removed, begin, end);
+        } else {
+            dispatchPixelType(m_image.type(), [&](auto pixel) {
+                removeRowsInto<decltype(pixel)>(m_image, result, removed, begin, end);
+            });
+            if (!index.empty()) removeRowsInto<cv::Vec2i>(m_indexMap, index, removed, begin, end);
+        }
+    });
+
+    if (vertical) {
+        m_protection.removeColumns(removed);
+        m_removal.removeColumns(removed);
+    } else {
+        m_protection.removeRows(removed);
+        m_removal.removeRows(removed);
+    }
+
+    m_image = result;
+    m_indexMap = index;
+}
+
+void SeamCarver::addVerticalSeams(std::vector<std::vector<int>>& seams) {
+    int numSeams = seams.size();
+    cv::Mat result = allocateImage(m_image.rows, m_image.cols + numSeams);
+    cv::Mat index = resizedLike(m_indexMap, 0, numSeams);
+    countAllocation(m_stats.insertion, result, {&index});
+
+    parallelRows(m_image.rows, [&](int begin, int end) {
+        dispatchPixelType(m_image.type(), [&](auto pixel) {
+            addVerticalSeamsInto<decltype(pixel)>(m_image, result, seams, begin, end);
+        });
+        // Inserted pixels map back to the seam pixel they were created from.
+        if (!index.empty()) addVerticalSeamsInto<cv::Vec2i, false>(m_indexMap, index, seams, begin, end);
+    });
+
+    m_image = result;
+    m_indexMap = index;
+    // Inserted pixels inside a masked run stay masked.
+    m_protection.insertVerticalSeams(seams);
+    m_removal.insertVerticalSeams(seams);
+}
+
+void SeamCarver::addHorizontalSeams(std::vector<std::vector<int>>& seams) {
+    // --- Transpose Method ---
+    // A horizontal seam (one row index per column) is a vertical seam
+    // (one column index per row) of the transposed image. The transposed
+    // result cannot live in the output buffer; resize() copies it there.
+    cv::Mat outputBuffer = m_outputBuffer;
+    m_outputBuffer = cv::Mat();
+    // The masks follow the seams along columns instead of being transposed.
+    SpanMask protection = std::move(m_protection);
+    SpanMask removal = std::move(m_removal);
+    m_protection = SpanMask();
+    m_removal = SpanMask();
+
+    m_image = m_image.t();
+    if (!m_indexMap.empty()) m_indexMap = m_indexMap.t();
+    m_stats.insertion.bytesAllocated += matBytes(m_image) + matBytes(m_indexMap);
+    addVerticalSeams(seams);
+    m_image = m_image.t();
+    if (!m_indexMap.empty()) m_indexMap = m_indexMap.t();
+    m_stats.insertion.bytesAllocated += matBytes(m_image) + matBytes(m_indexMap);
+
+    protection.insertHorizontalSeams(seams);
+    removal.insertHorizontalSeams(seams);
+    m_protection = std::move(protection);
+    m_removal = std::move(removal);
+    m_outputBuffer = outputBuffer;
+}
+
+// ---
+// Output
+// ---
+
+const cv::Mat& SeamCarver::image() const {
+    return m_image;
+}
+
+int SeamCarver::width() const {
+    return m_image.cols;
+}
+
+int SeamCarver::height() const {
+    return m_image.rows;
+}
+
+void SeamCarver::setOutputBuffer(void* data, int width, int height, size_t stride) {
+    if (data == nullptr) {
+        m_outputBuffer = cv::Mat();
+        return;
+    }
+    if (width <= 0 || height <= 0) {
+        throw std::invalid_argument("Invalid output buffer dimensions.");
+    }
+    m_outputBuffer = cv::Mat(height, width, m_image.type(), data, stride);
+}
+
+void SeamCarver::setOutputBuffer(const cv::Mat& buffer) {
+    if (!buffer.empty() && buffer.type() != m_image.type()) {
+        throw std::invalid_argument("Output buffer type does not match the input image type.");
+    }
+    m_outputBuffer = buffer;
+}
+
+void SeamCarver::copyImageTo(void* data, size_t stride) const {
+    if (data == nullptr) {
+        throw std::invalid_argument("Destination buffer is NULL.");
+    }
+    cv::Mat destination(m_image.rows, m_image.cols, m_image.type(), data, stride);
+    m_image.copyTo(destination);
+}
+
+void SeamCarver::setTrackIndexMap(bool enabled) {
+    m_trackIndexMap = enabled;
+    if (!enabled) {
+        m_indexMap = cv::Mat();
+    }
+}
+
+const cv::Mat& SeamCarver::indexMap() const {
+    return m_indexMap;
+}
+
+const std::vector<SeamRecord>& SeamCarver::seams() const {
+    return m_seams;
+}
+
+const std::vector<ScaleRecord>& SeamCarver::scaleSteps() const {
+    return m_scales;
+}
+
+const ResizeStats& SeamCarver::stats() const {
+    return m_stats;
+}
+
+std::string ResizeStats::toJson() const {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+    out << "{\"input\":{\"width\":" << inputWidth << ",\"height\":" << inputHeight << "}"
+        << ",\"output\":{\"width\":" << outputWidth << ",\"height\":" << outputHeight << "}"
+        << ",\"energy_function\":\"" << energyFunction << "\""
+        << ",\"seams_removed\":" << seamsRemoved << ",\"seams_inserted\":" << seamsInserted
+        << ",\"seams_scaled\":" << seamsScaled << ",\"max_energy_interval\":" << maxEnergyInterval
+        << ",\"roi_searches\":" << roiSearches << ",\"roi_fallbacks\":" << roiFallbacks
+        << ",\"guided_searches\":" << guidedSearches << ",\"proxy_seams\":" << proxySeams
+        << ",\"cancelled\":" << (cancelled ? "true" : "false") << ",\"total_ms\":" << totalMilliseconds << ",\"phases\":{";
+    writePhaseJson(out, "energy", energy);
+    out << ",";
+    writePhaseJson(out, "vertical_search", verticalSearch);
+    out << ",";
+    writePhaseJson(out, "horizontal_search", horizontalSearch);
+    out << ",";
+    writePhaseJson(out, "removal", removal);
+    out << ",";
+    writePhaseJson(out, "insertion", insertion);
+    out << ",";
+    writePhaseJson(out, "scaling", scaling);
+    out << ",";
+    writePhaseJson(out, "proxy", proxy);
+    out << "}}";
+    return out.str();
+}
+
+void SeamCarver::saveImage(const std::string& outputPath) {
+    if (!cv::imwrite(outputPath, m_image)) {
+        throw std::runtime_error("Failed to save image to: " + outputPath);
+    }
+    m_logger.info([&] { return "Image saved successfully to: " + outputPath; });
+}
+
+void SeamCarver::showImage(const std::string& windowName) {
+    cv::imshow(windowName, m_image);
+    std::cout << "Press any key to close the image window..." << std::endl;
+    cv::waitKey(0);
+}
@@ -0,0 +1,220 @@
+/**
+ * @file seam_file.cpp
+ * @author Utkarsh Sachan
+ * @brief Implementation of the `.seams` format (see seam_file.hpp).
+ */
+
+#include "seam_file.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+
+namespace {
+
+const char SEAM_FILE_MAGIC[4] = {'S', 'C', 'S', 'M'};
+const unsigned char FLAG_HORIZONTAL = 0x01;
+const unsigned char FLAG_INSERTED = 0x02;
+const unsigned char STEP_JUMP = 0xC0;
+const int MAX_RUN = 64;
+
+void writeVarint(std::ostream& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.put(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.put(static_cast<char>(value));
+}
+
+void writeZigzag(std::ostream& out, int64_t value) {
+    writeVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+unsigned char readByte(std::istream& in) {
+    int byte = in.get();
+    if (byte == std::char_traits<char>::eof()) {
+        throw std::runtime_error("Seam file is truncated.");
+    }
+    return static_cast<unsigned char>(byte);
+}
+
+uint64_t readVarint(std::istream& in) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        unsigned char byte = readByte(in);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    throw std::runtime_error("Seam file has an invalid number.");
+}
+
+int64_t readZigzag(std::istream& in) {
+    uint64_t value = readVarint(in);
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+/**
+ * @brief Reads a non-negative int field, rejecting values that cannot be a dimension or index.
+ */
+int readInt(std::istream& in) {
+    uint64_t value = readVarint(in);
+    if (value > static_cast<uint64_t>(std::numeric_limits<int>::max())) {
+        throw std::runtime_error("Seam file has an out-of-range value.");
+    }
+    return static_cast<int>(value);
+}
+
+void writeSteps(std::ostream& out, const std::vector<int>& indices) {
+    size_t k = 1;
+    while (k < indices.size()) {
+        const int step = indices[k] - indices[k - 1];
+        if (step < -1 || step > 1) {
+            out.put(static_cast<char>(STEP_JUMP));
+            writeZigzag(out, step);
+            ++k;
+            continue;
+        }
+        int run = 1;
+        while (run < MAX_RUN && k + run < indices.size() && indices[k + run] - indices[k + run - 1] == step) {
+            ++run;
+        }
+        out.put(static_cast<char>(((step + 1) << 6) | (run - 1)));
+        k += run;
+    }
+}
+
+void readSteps(std::istream& in, std::vector<int>& indices) {
+    size_t k = 1;
+    while (k < indices.size()) {
+        const unsigned char byte = readByte(in);
+        if (byte == STEP_JUMP) {
+            indices[k] = static_cast<int>(indices[k - 1] + readZigzag(in));
+            ++k;
+            continue;
+        }
+        const int step = (byte >> 6) - 1;
+        const size_t run = (byte & 0x3F) + 1u;
+        if (step > 1 || k + run > indices.size()) {
+            throw std::runtime_error("Seam file has an invalid seam.");
+        }
+        for (size_t end = k + run; k < end; ++k) {
+            indices[k] = indices[k - 1] + step;
+        }
+    }
+}
+
+} // namespace
+
+// ---
+// Streams
+// ---
+
+void writeSeamLog(std::ostream& out, const SeamLog& log) {
+    out.write(SEAM_FILE_MAGIC, sizeof(SEAM_FILE_MAGIC));
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.put(static_cast<char>((SEAM_FILE_VERSION >> shift) & 0xFF));
+    }
+    writeVarint(out, static_cast<uint64_t>(log.inputWidth));
+    writeVarint(out, static_cast<uint64_t>(log.inputHeight));
+    writeVarint(out, static_cast<uint64_t>(log.outputWidth));
+    writeVarint(out, static_cast<uint64_t>(log.outputHeight));
+    writeVarint(out, log.seams.size());
+
+    for (const SeamRecord& seam : log.seams) {
+        unsigned char flags = 0;
+        if (seam.direction == SeamDirection::Horizontal) flags |= FLAG_HORIZONTAL;
+        if (seam.inserted) flags |= FLAG_INSERTED;
+        out.put(static_cast<char>(flags));
+        writeVarint(out, seam.indices.size());
+        if (!seam.indices.empty()) {
+            writeVarint(out, static_cast<uint64_t>(seam.indices.front()));
+            writeSteps(out, seam.indices);
+        }
+    }
+    writeVarint(out, log.scales.size());
+    for (const ScaleRecord& step : log.scales) {
+        writeVarint(out, step.position);
+        writeVarint(out, static_cast<uint64_t>(step.width));
+        writeVarint(out, static_cast<uint64_t>(step.height));
+    }
+    if (!out) {
+        throw std::runtime_error("Could not write seam file.");
+    }
+}
+
+SeamLog readSeamLog(std::istream& in) {
+    char magic[sizeof(SEAM_FILE_MAGIC)];
+    if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), SEAM_FILE_MAGIC)) {
+        throw std::runtime_error("Not a seam file.");
+    }
+    uint32_t version = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        version |= static_cast<uint32_t>(readByte(in)) << shift;
+    }
+    if (version < 1 || version > SEAM_FILE_VERSION) {
+        throw std::runtime_error("Unsupported seam file version " + std::to_string(version) + ".");
+    }
+
+    SeamLog log;
+    log.inputWidth = readInt(in);
+    log.inputHeight = readInt(in);
+    log.outputWidth = readInt(in);
+    log.outputHeight = readInt(in);
+    const int count = readInt(in);
+    for (int i = 0; i < count; ++i) {
+        SeamRecord seam;
+        const unsigned char flags = readByte(in);
+        seam.direction = (flags & FLAG_HORIZONTAL) ? SeamDirection::Horizontal : SeamDirection::Vertical;
+        seam.inserted = (flags & FLAG_INSERTED) != 0;
+        // Seams are at most as long as the image is wide or tall.
+        const int length = readInt(in);
+        if (length > std::max(log.inputWidth, log.inputHeight) + std::max(log.outputWidth, log.outputHeight)) {
+            throw std::runtime_error("Seam file has an invalid seam.");
+        }
+        seam.indices.resize(length);
+        if (length > 0) {
+            seam.indices[0] = readInt(in);
+            readSteps(in, seam.indices);
+        }
+        log.seams.push_back(std::move(seam));
+    }
+    if (version >= 2) {
+        const int steps = readInt(in);
+        for (int i = 0; i < steps; ++i) {
+            ScaleRecord step;
+            step.position = static_cast<size_t>(readInt(in));
+            step.width = readInt(in);
+            step.height = readInt(in);
+            if (step.position > log.seams.size() || (!log.scales.empty() && step.position < log.scales.back().position)) {
+                throw std::runtime_error("Seam file has an invalid scaling step.");
+            }
+            log.scales.push_back(step);
+        }
+    }
+    return log;
+}
+
+// ---
+// Files
+// ---
+
+void saveSeamLog(const std::string& path, const SeamLog& log) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("Could not write seam file: " + path);
+    }
+    writeSeamLog(out, log);
+}
+
+SeamLog loadSeamLog(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Could not open seam file: " + path);
+    }
+    return readSeamLog(in);
+}
@@ -0,0 +1,73 @@
+/**
+ * @file seam_file.hpp
+ * @author Utkarsh Sachan
+ * @brief Compact on-disk format for the seams of a carve, for audit and replay.
+ *
+ * A `.seams` file records what resize() did (SeamCarver::seams()) so the same
+ * carve can be applied to other renditions of the image with
+ * SeamCarver::applySeams(), without energy maps or seam searches.
+ *
+ * Layout (little-endian; "varint" = LEB128, "zigzag" = signed varint):
+ *
+ *   "SCSM", u32 version, varint inputWidth, inputHeight, outputWidth,
+ *   outputHeight, seamCount, then per seam:
+ *     u8 flags (bit 0: horizontal, bit 1: inserted), varint length,
+ *     varint first index, then the length - 1 steps between neighbors;
+ *   then (version 2) varint scaleCount and per scaling step:
+ *     varint position (seams before it), width, height.
+ *
+ * Version 1 files have no scaling steps; the replay infers them.
+ *
+ * Steps are run-length coded one byte per run: the top two bits hold the step
+ * (0 = -1, 1 = 0, 2 = +1) and the low six bits the run length minus one.
+ * Searched seams only ever step by one pixel, so a seam costs well under a
+ * byte per row instead of four; larger jumps (inserted seams in original
+ * coordinates) are written as a 0xC0 byte followed by a zigzag step.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "seam_carver.hpp"
+
+const uint32_t SEAM_FILE_VERSION = 2;
+
+/**
+ * @brief A recorded carve: the seams and the sizes they take the image between.
+ */
+struct SeamLog {
+    int inputWidth = 0;
+    int inputHeight = 0;
+    int outputWidth = 0;
+    int outputHeight = 0;
+    std::vector<SeamRecord> seams;
+    std::vector<ScaleRecord> scales; ///< Scaling steps among the seams (SeamCarver::scaleSteps()).
+};
+
+/**
+ * @brief Encodes a seam log in the `.seams` format.
+ * @throws std::runtime_error if the stream fails.
+ */
+void writeSeamLog(std::ostream& out, const SeamLog& log);
+
+/**
+ * @brief Decodes a `.seams` stream.
+ * @throws std::runtime_error if the stream is truncated or not a seam file.
+ */
+SeamLog readSeamLog(std::istream& in);
+
+/**
+ * @brief Writes a seam log to a file.
+ * @throws std::runtime_error if the file cannot be written.
+ */
+void saveSeamLog(const std::string& path, const SeamLog& log);
+
+/**
+ * @brief Reads a seam log from a file.
+ * @throws std::runtime_error if the file cannot be read or is not a seam file.
+ */
+SeamLog loadSeamLog(const std::string& path);
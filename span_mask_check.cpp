@@ -0,0 +1,289 @@
+/**
+ * @file span_mask_check.cpp
+ * @author Utkarsh Sachan
+ * @brief Checks SpanMask against a plain raster mask under random carving.
+ *
+ * Each trial builds a random mask (blocks plus scattered pixels), then applies
+ * the same random sequence of seam removals, batched removals, seam
+ * insertions and direction switches to a SpanMask and to a CV_8U raster that
+ * is updated pixel by pixel. After every step the two must agree exactly, as
+ * must bounds(); the reductions and resizes the proxy search uses are
+ * compared with brute-force rasters too.
+ *
+ * Raster rules the runs must follow:
+ * - a removed pixel disappears and the rest of its line closes up;
+ * - a pixel inserted after position p takes the mask value of p.
+ *
+ * Build:
+ * g++ -std=c++17 -O2 -o span_mask_check span_mask_check.cpp vector_mask.cpp `pkg-config --cflags --libs opencv4`
+ *
+ * Usage:
+ * ./span_mask_check     # exits non-zero on the first mismatch
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "vector_mask.hpp"
+
+namespace {
+
+const int TRIALS = 200;
+const int STEPS_PER_TRIAL = 40;
+
+// ---
+// Reference raster operations
+// ---
+
+/**
+ * @brief Removes the listed pixels of each row (vertical) or column (horizontal).
+ * @param positions Per line, the sorted, distinct indices to drop.
+ */
+cv::Mat rasterRemove(const cv::Mat& mask, const std::vector<std::vector<int>>& positions, bool vertical) {
+    cv::Mat source = vertical ? mask : cv::Mat(mask.t());
+    const int dropped = static_cast<int>(positions[0].size());
+    cv::Mat result(source.rows, source.cols - dropped, CV_8UC1);
+    for (int r = 0; r < source.rows; ++r) {
+        const std::vector<int>& drop = positions[r];
+        int out = 0;
+        for (int c = 0; c < source.cols; ++c) {
+            if (!std::binary_search(drop.begin(), drop.end(), c)) {
+                result.at<uchar>(r, out++) = source.at<uchar>(r, c);
+            }
+        }
+    }
+    return vertical ? result : cv::Mat(result.t());
+}
+
+/**
+ * @brief Inserts a copy of each listed pixel right after it.
+ * @param positions Per line, the sorted indices (repeats insert several pixels).
+ */
+cv::Mat rasterInsert(const cv::Mat& mask, const std::vector<std::vector<int>>& positions, bool vertical) {
+    cv::Mat source = vertical ? mask : cv::Mat(mask.t());
+    const int added = static_cast<int>(positions[0].size());
+    cv::Mat result(source.rows, source.cols + added, CV_8UC1);
+    for (int r = 0; r < source.rows; ++r) {
+        const std::vector<int>& after = positions[r];
+        int out = 0;
+        for (int c = 0; c < source.cols; ++c) {
+            const uchar value = source.at<uchar>(r, c);
+            result.at<uchar>(r, out++) = value;
+            const long copies = std::upper_bound(after.begin(), after.end(), c) - std::lower_bound(after.begin(), after.end(), c);
+            for (long k = 0; k < copies; ++k) {
+                result.at<uchar>(r, out++) = value;
+            }
+        }
+    }
+    return vertical ? result : cv::Mat(result.t());
+}
+
+/**
+ * @brief Nearest-neighbour resize: pixel (x, y) samples (x * w / W, y * h / H), rounded down.
+ */
+cv::Mat rasterResized(const cv::Mat& mask, const cv::Size& size) {
+    cv::Mat result(size, CV_8UC1);
+    for (int y = 0; y < size.height; ++y) {
+        for (int x = 0; x < size.width; ++x) {
+            result.at<uchar>(y, x) = mask.at<uchar>(static_cast<int>(static_cast<long long>(y) * mask.rows / size.height),
+                                                    static_cast<int>(static_cast<long long>(x) * mask.cols / size.width));
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Area reduction: a pixel is masked if any source pixel it overlaps is.
+ */
+cv::Mat rasterReduced(const cv::Mat& mask, const cv::Size& size) {
+    auto first = [](long long i, long long src, long long dst) { return static_cast<int>(i * src / dst); };
+    auto last = [](long long i, long long src, long long dst) { return static_cast<int>(((i + 1) * src + dst - 1) / dst); };
+    cv::Mat result(size, CV_8UC1);
+    for (int y = 0; y < size.height; ++y) {
+        for (int x = 0; x < size.width; ++x) {
+            cv::Rect area(cv::Point(first(x, mask.cols, size.width), first(y, mask.rows, size.height)),
+                          cv::Point(last(x, mask.cols, size.width), last(y, mask.rows, size.height)));
+            result.at<uchar>(y, x) = (cv::countNonZero(mask(area)) > 0) ? 255 : 0;
+        }
+    }
+    return result;
+}
+
+// ---
+// Random inputs
+// ---
+
+cv::Mat randomMask(cv::RNG& rng, const cv::Size& size) {
+    cv::Mat mask = cv::Mat::zeros(size, CV_8UC1);
+    for (int i = rng.uniform(0, 5); i > 0; --i) {
+        cv::Point a(rng.uniform(0, size.width), rng.uniform(0, size.height));
+        cv::Point b(rng.uniform(a.x, size.width) + 1, rng.uniform(a.y, size.height) + 1);
+        mask(cv::Rect(a, b)).setTo(cv::Scalar(255));
+    }
+    for (int i = rng.uniform(0, size.area() / 8 + 1); i > 0; --i) {
+        mask.at<uchar>(rng.uniform(0, size.height), rng.uniform(0, size.width)) = 255;
+    }
+    return mask;
+}
+
+/**
+ * @brief A seam: one index per line, each in [0, extent).
+ */
+std::vector<int> randomSeam(cv::RNG& rng, int lines, int extent) {
+    std::vector<int> seam(lines);
+    for (int& index : seam) {
+        index = rng.uniform(0, extent);
+    }
+    return seam;
+}
+
+/**
+ * @brief Per line, `count` sorted indices in [0, extent) (distinct if `distinct`).
+ */
+std::vector<std::vector<int>> randomPositions(cv::RNG& rng, int lines, int extent, int count, bool distinct) {
+    std::vector<std::vector<int>> positions(lines);
+    for (std::vector<int>& line : positions) {
+        while (static_cast<int>(line.size()) < count) {
+            int index = rng.uniform(0, extent);
+            if (!distinct || std::find(line.begin(), line.end(), index) == line.end()) {
+                line.push_back(index);
+            }
+        }
+        std::sort(line.begin(), line.end());
+    }
+    return positions;
+}
+
+/**
+ * @brief Transposes per-line positions into per-seam lists (what the SpanMask takes).
+ */
+std::vector<std::vector<int>> toSeams(const std::vector<std::vector<int>>& positions) {
+    std::vector<std::vector<int>> seams(positions[0].size(), std::vector<int>(positions.size()));
+    for (size_t line = 0; line < positions.size(); ++line) {
+        for (size_t k = 0; k < positions[line].size(); ++k) {
+            seams[k][line] = positions[line][k];
+        }
+    }
+    return seams;
+}
+
+cv::Mat toPositionMat(const std::vector<std::vector<int>>& positions) {
+    cv::Mat mat(static_cast<int>(positions.size()), static_cast<int>(positions[0].size()), CV_32S);
+    for (int line = 0; line < mat.rows; ++line) {
+        std::copy(positions[line].begin(), positions[line].end(), mat.ptr<int>(line));
+    }
+    return mat;
+}
+
+// ---
+// Comparison
+// ---
+
+bool sameMask(const SpanMask& spans, const cv::Mat& raster) {
+    if (spans.size() != raster.size()) {
+        return false;
+    }
+    cv::Mat rendered = spans.toMat();
+    return cv::norm(rendered, raster, cv::NORM_INF) == 0 && spans.bounds() == cv::boundingRect(raster);
+}
+
+bool check(bool ok, int trial, int step, const std::string& what) {
+    if (!ok) {
+        std::cerr << "Mismatch in trial " << trial << ", step " << step << ": " << what << std::endl;
+    }
+    return ok;
+}
+
+/**
+ * @brief Runs one random sequence; returns false on the first mismatch.
+ */
+bool runTrial(int trial, cv::RNG& rng) {
+    cv::Mat raster = randomMask(rng, cv::Size(rng.uniform(2, 40), rng.uniform(2, 40)));
+    SpanMask spans = SpanMask::fromMat(raster);
+    if (!check(sameMask(spans, raster), trial, 0, "fromMat")) {
+        return false;
+    }
+
+    for (int step = 1; step <= STEPS_PER_TRIAL; ++step) {
+        // Vertical and horizontal operations alternate at random, so the runs
+        // switch between rows and columns many times per trial.
+        const bool vertical = rng.uniform(0, 2) == 0;
+        const int lines = vertical ? raster.rows : raster.cols;
+        const int extent = vertical ? raster.cols : raster.rows;
+        std::string what;
+        switch (rng.uniform(0, 3)) {
+            case 0: {
+                if (extent < 2) continue;
+                std::vector<int> seam = randomSeam(rng, lines, extent);
+                std::vector<std::vector<int>> positions(lines);
+                for (int line = 0; line < lines; ++line) {
+                    positions[line] = {seam[line]};
+                }
+                raster = rasterRemove(raster, positions, vertical);
+                if (vertical) {
+                    spans.removeVerticalSeam(seam);
+                } else {
+                    spans.removeHorizontalSeam(seam);
+                }
+                what = vertical ? "removeVerticalSeam" : "removeHorizontalSeam";
+                break;
+            }
+            case 1: {
+                if (extent < 3) continue;
+                std::vector<std::vector<int>> positions = randomPositions(rng, lines, extent, rng.uniform(1, extent - 1), true);
+                raster = rasterRemove(raster, positions, vertical);
+                cv::Mat removed = toPositionMat(positions);
+                if (vertical) {
+                    spans.removeColumns(removed);
+                } else {
+                    spans.removeRows(removed);
+                }
+                what = vertical ? "removeColumns" : "removeRows";
+                break;
+            }
+            default: {
+                if (extent > 60) continue;
+                std::vector<std::vector<int>> positions = randomPositions(rng, lines, extent, rng.uniform(1, 6), false);
+                raster = rasterInsert(raster, positions, vertical);
+                std::vector<std::vector<int>> seams = toSeams(positions);
+                if (vertical) {
+                    spans.insertVerticalSeams(seams);
+                } else {
+                    spans.insertHorizontalSeams(seams);
+                }
+                what = vertical ? "insertVerticalSeams" : "insertHorizontalSeams";
+                break;
+            }
+        }
+        if (!check(sameMask(spans, raster), trial, step, what)) {
+            return false;
+        }
+
+        // The proxy search works on reduced copies; resized() follows scaling.
+        cv::Size smaller(rng.uniform(1, raster.cols + 1), rng.uniform(1, raster.rows + 1));
+        if (!check(sameMask(spans.reduced(smaller), rasterReduced(raster, smaller)), trial, step, "reduced")) {
+            return false;
+        }
+        cv::Size other(rng.uniform(1, 2 * raster.cols + 1), rng.uniform(1, 2 * raster.rows + 1));
+        if (!check(sameMask(spans.resized(other), rasterResized(raster, other)), trial, step, "resized")) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    cv::RNG rng(12345);
+    for (int trial = 0; trial < TRIALS; ++trial) {
+        if (!runTrial(trial, rng)) {
+            return 1;
+        }
+    }
+    std::cout << "All " << TRIALS << " span mask trials match the raster." << std::endl;
+    return 0;
+}
@@ -0,0 +1,230 @@
+/**
+ * @file thread_pool.hpp
+ * @author Utkarsh Sachan
+ * @brief A small work-stealing thread pool used by batch mode and by the carver.
+ *
+ * Each worker owns a deque. Tasks submitted from a worker go to the back of
+ * its own deque and are popped LIFO (cache-warm); idle workers steal from the
+ * front of other deques. `parallelFor` is fork-join: the calling thread claims
+ * chunks itself while pool workers help, so it never blocks on unrelated
+ * work. Long-running loops that call parallelFor (batch carvers, daemon
+ * connections) belong on their own threads: as pool tasks they would hold the
+ * workers their helper chunks need.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    /**
+     * @brief Starts the workers.
+     * @param threads Number of worker threads (0 = hardware concurrency).
+     */
+    explicit ThreadPool(unsigned threads = 0) {
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (unsigned i = 0; i < threads; ++i) {
+            m_queues.emplace_back(new Queue);
+        }
+        for (unsigned i = 0; i < threads; ++i) {
+            m_threads.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Finishes all queued tasks, then joins the workers.
+     */
+    ~ThreadPool() {
+        wait();
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (std::thread& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    /**
+     * @brief Number of worker threads.
+     */
+    int size() const {
+        return static_cast<int>(m_threads.size());
+    }
+
+    /**
+     * @brief Queues a task. Tasks must not throw.
+     */
+    void submit(std::function<void()> task) {
+        size_t index = (currentPool() == this) ? currentWorker()
+                                               : m_nextQueue.fetch_add(1) % m_queues.size();
+        m_pending.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+            m_queues[index]->tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            m_queued.fetch_add(1);
+        }
+        m_wake.notify_one();
+    }
+
+    /**
+     * @brief Blocks until every submitted task has finished.
+     * Must not be called from a worker thread.
+     */
+    void wait() {
+        std::unique_lock<std::mutex> lock(m_idleMutex);
+        m_idle.wait(lock, [this] { return m_pending.load() == 0; });
+    }
+
+    /**
+     * @brief Runs `fn(begin, end)` over [0, count) split into at most `chunks` ranges.
+     *
+     * The caller executes chunks itself and up to `chunks - 1` pool workers
+     * help, but only as many as are idle: helpers queued behind busy workers
+     * would find no chunk left by the time they run. Returns when all chunks
+     * are done; rethrows the first exception.
+     */
+    void parallelFor(int count, int chunks, const std::function<void(int, int)>& fn) {
+        chunks = std::max(1, std::min(chunks, count));
+        if (chunks == 1) {
+            if (count > 0) fn(0, count);
+            return;
+        }
+
+        auto job = std::make_shared<ParallelJob>();
+        job->count = count;
+        job->chunks = chunks;
+        job->fn = &fn;
+        const long long idle = static_cast<long long>(m_threads.size()) - static_cast<long long>(m_busy.load() + m_queued.load());
+        const int helpers = static_cast<int>(std::max(0LL, std::min<long long>(chunks - 1, idle)));
+        for (int i = 0; i < helpers; ++i) {
+            submit([job] { job->run(); });
+        }
+        job->run();
+
+        // Only chunks already claimed by helpers can be outstanding here.
+        while (job->done.load() < chunks) {
+            std::this_thread::yield();
+        }
+        if (job->error) {
+            std::rethrow_exception(job->error);
+        }
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    /**
+     * @brief Shared state of one parallelFor call; chunks are claimed atomically.
+     */
+    struct ParallelJob {
+        int count = 0;
+        int chunks = 0;
+        const std::function<void(int, int)>* fn = nullptr;
+        std::atomic<int> next{0};
+        std::atomic<int> done{0};
+        std::mutex errorMutex;
+        std::exception_ptr error;
+
+        void run() {
+            for (int chunk = next.fetch_add(1); chunk < chunks; chunk = next.fetch_add(1)) {
+                int begin = static_cast<int>(static_cast<long long>(count) * chunk / chunks);
+                int end = static_cast<int>(static_cast<long long>(count) * (chunk + 1) / chunks);
+                try {
+                    (*fn)(begin, end);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!error) error = std::current_exception();
+                }
+                done.fetch_add(1);
+            }
+        }
+    };
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_threads;
+    std::atomic<size_t> m_nextQueue{0};
+    std::atomic<size_t> m_queued{0};
+    std::atomic<size_t> m_pending{0};
+    std::atomic<size_t> m_busy{0}; ///< Workers currently running a task.
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+    std::mutex m_idleMutex;
+    std::condition_variable m_idle;
+    bool m_stop = false;
+
+    static ThreadPool*& currentPool() {
+        static thread_local ThreadPool* pool = nullptr;
+        return pool;
+    }
+
+    static size_t& currentWorker() {
+        static thread_local size_t index = 0;
+        return index;
+    }
+
+    /**
+     * @brief Pops from the worker's own deque (LIFO) or steals from another (FIFO).
+     */
+    bool tryRunOne(size_t self) {
+        const size_t n = m_queues.size();
+        for (size_t k = 0; k < n; ++k) {
+            Queue& queue = *m_queues[(self + k) % n];
+            std::function<void()> task;
+            {
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if (queue.tasks.empty()) continue;
+                if (k == 0) {
+                    task = std::move(queue.tasks.back());
+                    queue.tasks.pop_back();
+                } else {
+                    task = std::move(queue.tasks.front());
+                    queue.tasks.pop_front();
+                }
+            }
+            m_queued.fetch_sub(1);
+            m_busy.fetch_add(1);
+            task();
+            m_busy.fetch_sub(1);
+            if (m_pending.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(m_idleMutex);
+                m_idle.notify_all();
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void workerLoop(size_t index) {
+        currentPool() = this;
+        currentWorker() = index;
+        for (;;) {
+            if (tryRunOne(index)) continue;
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_wake.wait(lock, [this] { return m_stop || m_queued.load() > 0; });
+            if (m_stop && m_queued.load() == 0) return;
+        }
+    }
+};
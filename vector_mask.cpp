@@ -0,0 +1,719 @@
+/**
+ * @file vector_mask.cpp
+ * @author Utkarsh Sachan
+ * @brief Implementation of span masks and the shape file format (see vector_mask.hpp).
+ */
+
+#include "vector_mask.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+// Nesting deeper than any shape file needs is rejected instead of recursing.
+const int MAX_JSON_DEPTH = 32;
+
+// ---
+// Runs
+// ---
+
+int ceilDiv(long long value, long long divisor) {
+    return static_cast<int>((value + divisor - 1) / divisor);
+}
+
+/**
+ * @brief Sorts a line's runs and merges the ones that overlap or touch.
+ */
+void normalizeLine(std::vector<MaskSpan>& line) {
+    std::sort(line.begin(), line.end(), [](const MaskSpan& a, const MaskSpan& b) { return a.begin < b.begin; });
+    size_t count = 0;
+    for (const MaskSpan& span : line) {
+        if (span.end <= span.begin) {
+            continue;
+        }
+        if (count > 0 && span.begin <= line[count - 1].end) {
+            line[count - 1].end = std::max(line[count - 1].end, span.end);
+        } else {
+            line[count++] = span;
+        }
+    }
+    line.resize(count);
+}
+
+/**
+ * @brief Moves a line's runs past the removal of the given sorted positions.
+ * Each endpoint drops by the number of removed pixels before it; runs that
+ * lose all their pixels disappear.
+ */
+void removeFromLine(std::vector<MaskSpan>& line, const int* positions, int count) {
+    size_t kept = 0;
+    for (MaskSpan span : line) {
+        span.begin -= static_cast<int>(std::lower_bound(positions, positions + count, span.begin) - positions);
+        span.end -= static_cast<int>(std::lower_bound(positions, positions + count, span.end) - positions);
+        if (span.end > span.begin) {
+            line[kept++] = span;
+        }
+    }
+    line.resize(kept);
+}
+
+/**
+ * @brief Moves a line's runs past pixels inserted after the given sorted positions.
+ */
+void insertIntoLine(std::vector<MaskSpan>& line, const int* positions, int count) {
+    for (MaskSpan& span : line) {
+        span.begin += static_cast<int>(std::lower_bound(positions, positions + count, span.begin) - positions);
+        span.end += static_cast<int>(std::lower_bound(positions, positions + count, span.end) - positions);
+    }
+}
+
+/**
+ * @brief Adds the runs of one polygon (even-odd, pixel centers) to the rows it crosses.
+ */
+void fillPolygon(std::vector<std::vector<MaskSpan>>& rows, const std::vector<cv::Point2f>& polygon, int width) {
+    float minY = polygon.front().y;
+    float maxY = minY;
+    for (const cv::Point2f& point : polygon) {
+        minY = std::min(minY, point.y);
+        maxY = std::max(maxY, point.y);
+    }
+    const int height = static_cast<int>(rows.size());
+    const int first = std::max(0, static_cast<int>(std::ceil(minY - 0.5f)));
+    const int last = std::min(height, static_cast<int>(std::ceil(maxY - 0.5f)));
+
+    std::vector<float> crossings;
+    for (int y = first; y < last; ++y) {
+        const float center = y + 0.5f;
+        crossings.clear();
+        for (size_t i = 0; i < polygon.size(); ++i) {
+            const cv::Point2f& p = polygon[i];
+            const cv::Point2f& q = polygon[(i + 1) % polygon.size()];
+            if ((p.y <= center) != (q.y <= center)) {
+                crossings.push_back(p.x + (center - p.y) * (q.x - p.x) / (q.y - p.y));
+            }
+        }
+        std::sort(crossings.begin(), crossings.end());
+        for (size_t i = 0; i + 1 < crossings.size(); i += 2) {
+            const int begin = std::max(0, static_cast<int>(std::ceil(crossings[i] - 0.5f)));
+            const int end = std::min(width, static_cast<int>(std::ceil(crossings[i + 1] - 0.5f)));
+            if (end > begin) {
+                rows[y].push_back({begin, end});
+            }
+        }
+    }
+}
+
+// ---
+// JSON
+// ---
+
+/**
+ * @brief A parsed JSON value; only what shape files need.
+ */
+struct JsonValue {
+    enum class Type { Null, Boolean, Number, String, Array, Object };
+    Type type = Type::Null;
+    double number = 0.0;
+    std::string text;
+    std::vector<JsonValue> items;
+    std::vector<std::pair<std::string, JsonValue>> members;
+
+    const JsonValue* find(const std::string& key) const {
+        for (const auto& member : members) {
+            if (member.first == key) {
+                return &member.second;
+            }
+        }
+        return nullptr;
+    }
+};
+
+/**
+ * @class JsonParser
+ * @brief A small recursive-descent JSON parser.
+ */
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& text) : m_text(text) {}
+
+    JsonValue parse() {
+        JsonValue value = parseValue(0);
+        skipSpace();
+        if (m_pos != m_text.size()) {
+            fail("unexpected trailing characters");
+        }
+        return value;
+    }
+
+private:
+    [[noreturn]] void fail(const std::string& what) const {
+        throw std::runtime_error("Invalid mask shapes JSON: " + what + " at offset " + std::to_string(m_pos) + ".");
+    }
+
+    void skipSpace() {
+        while (m_pos < m_text.size() && std::isspace(static_cast<unsigned char>(m_text[m_pos]))) {
+            ++m_pos;
+        }
+    }
+
+    bool consume(char ch) {
+        skipSpace();
+        if (m_pos < m_text.size() && m_text[m_pos] == ch) {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char ch) {
+        if (!consume(ch)) {
+            fail(std::string("expected '") + ch + "'");
+        }
+    }
+
+    bool consumeWord(const char* word) {
+        const size_t length = std::char_traits<char>::length(word);
+        if (m_text.compare(m_pos, length, word) == 0) {
+            m_pos += length;
+            return true;
+        }
+        return false;
+    }
+
+    JsonValue parseValue(int depth) {
+        if (depth > MAX_JSON_DEPTH) {
+            fail("nesting too deep");
+        }
+        skipSpace();
+        if (m_pos >= m_text.size()) {
+            fail("unexpected end of input");
+        }
+        JsonValue value;
+        const char ch = m_text[m_pos];
+        if (ch == '{') {
+            ++m_pos;
+            value.type = JsonValue::Type::Object;
+            if (consume('}')) {
+                return value;
+            }
+            do {
+                skipSpace();
+                std::string key = parseString();
+                expect(':');
+                value.members.emplace_back(std::move(key), parseValue(depth + 1));
+            } while (consume(','));
+            expect('}');
+        } else if (ch == '[') {
+            ++m_pos;
+            value.type = JsonValue::Type::Array;
+            if (consume(']')) {
+                return value;
+            }
+            do {
+                value.items.push_back(parseValue(depth + 1));
+            } while (consume(','));
+            expect(']');
+        } else if (ch == '"') {
+            value.type = JsonValue::Type::String;
+            value.text = parseString();
+        } else if (consumeWord("true")) {
+            value.type = JsonValue::Type::Boolean;
+            value.number = 1.0;
+        } else if (consumeWord("false")) {
+            value.type = JsonValue::Type::Boolean;
+        } else if (consumeWord("null")) {
+            value.type = JsonValue::Type::Null;
+        } else {
+            const char* start = m_text.c_str() + m_pos;
+            char* end = nullptr;
+            value.type = JsonValue::Type::Number;
+            value.number = std::strtod(start, &end);
+            if (end == start) {
+                fail("unexpected character");
+            }
+            m_pos += static_cast<size_t>(end - start);
+        }
+        return value;
+    }
+
+    std::string parseString() {
+        if (m_pos >= m_text.size() || m_text[m_pos] != '"') {
+            fail("expected a string");
+        }
+        ++m_pos;
+        std::string result;
+        while (m_pos < m_text.size() && m_text[m_pos] != '"') {
+            char ch = m_text[m_pos++];
+            if (ch == '\\') {
+                if (m_pos >= m_text.size()) {
+                    break;
+                }
+                ch = m_text[m_pos++];
+                switch (ch) {
+                    case 'b': ch = '\b'; break;
+                    case 'f': ch = '\f'; break;
+                    case 'n': ch = '\n'; break;
+                    case 'r': ch = '\r'; break;
+                    case 't': ch = '\t'; break;
+                    case 'u':
+                        // Keys and modes are ASCII; other code points are kept as a placeholder.
+                        if (m_pos + 4 > m_text.size()) fail("truncated escape");
+                        m_pos += 4;
+                        ch = '?';
+                        break;
+                    default: break; // '"', '\\' and '/' stand for themselves
+                }
+            }
+            result += ch;
+        }
+        if (m_pos >= m_text.size()) {
+            fail("unterminated string");
+        }
+        ++m_pos;
+        return result;
+    }
+
+    const std::string& m_text;
+    size_t m_pos = 0;
+};
+
+double numberOf(const JsonValue& value) {
+    if (value.type != JsonValue::Type::Number || !std::isfinite(value.number)) {
+        throw std::runtime_error("Invalid mask shape: expected a number.");
+    }
+    return value.number;
+}
+
+MaskShape shapeFromJson(const JsonValue& value) {
+    if (value.type != JsonValue::Type::Object) {
+        throw std::runtime_error("Invalid mask shape: expected an object.");
+    }
+    MaskShape shape;
+    if (const JsonValue* mode = value.find("mode")) {
+        if (mode->type == JsonValue::Type::String && mode->text == "protect") {
+            shape.mode = MaskMode::Protect;
+        } else if (mode->type == JsonValue::Type::String && mode->text == "remove") {
+            shape.mode = MaskMode::Remove;
+        } else {
+            throw std::runtime_error("Invalid mask shape: mode must be \"protect\" or \"remove\".");
+        }
+    }
+
+    const JsonValue* rect = value.find("rect");
+    const JsonValue* polygon = value.find("polygon");
+    if ((rect == nullptr) == (polygon == nullptr)) {
+        throw std::runtime_error("Invalid mask shape: give exactly one of \"rect\" or \"polygon\".");
+    }
+    if (rect != nullptr) {
+        if (rect->type != JsonValue::Type::Array || rect->items.size() != 4) {
+            throw std::runtime_error("Invalid mask shape: rect must be [x, y, width, height].");
+        }
+        double x = numberOf(rect->items[0]), y = numberOf(rect->items[1]);
+        double width = numberOf(rect->items[2]), height = numberOf(rect->items[3]);
+        if (width < 0 || height < 0) {
+            throw std::runtime_error("Invalid mask shape: rect size must not be negative.");
+        }
+        shape.rect = cv::Rect(static_cast<int>(std::lround(x)), static_cast<int>(std::lround(y)),
+                              static_cast<int>(std::lround(width)), static_cast<int>(std::lround(height)));
+        return shape;
+    }
+    if (polygon->type != JsonValue::Type::Array || polygon->items.size() < 3) {
+        throw std::runtime_error("Invalid mask shape: polygon needs at least three [x, y] points.");
+    }
+    for (const JsonValue& point : polygon->items) {
+        if (point.type != JsonValue::Type::Array || point.items.size() != 2) {
+            throw std::runtime_error("Invalid mask shape: polygon points must be [x, y].");
+        }
+        shape.polygon.push_back(cv::Point2f(static_cast<float>(numberOf(point.items[0])),
+                                            static_cast<float>(numberOf(point.items[1]))));
+    }
+    return shape;
+}
+
+} // namespace
+
+// ---
+// SpanMask: construction
+// ---
+
+SpanMask SpanMask::fromShapes(const std::vector<MaskShape>& shapes, MaskMode mode, const cv::Size& size) {
+    SpanMask mask;
+    mask.m_size = size;
+    mask.m_lines.resize(size.height);
+    const cv::Rect bounds(0, 0, size.width, size.height);
+    for (const MaskShape& shape : shapes) {
+        if (shape.mode != mode) {
+            continue;
+        }
+        if (!shape.polygon.empty()) {
+            fillPolygon(mask.m_lines, shape.polygon, size.width);
+            continue;
+        }
+        const cv::Rect rect = shape.rect & bounds;
+        for (int y = rect.y; y < rect.y + rect.height; ++y) {
+            mask.m_lines[y].push_back({rect.x, rect.x + rect.width});
+        }
+    }
+    for (std::vector<MaskSpan>& line : mask.m_lines) {
+        normalizeLine(line);
+    }
+    return mask;
+}
+
+SpanMask SpanMask::fromMat(const cv::Mat& mask) {
+    SpanMask result;
+    if (mask.empty()) {
+        return result;
+    }
+    result.m_size = mask.size();
+    result.m_lines.resize(mask.rows);
+    for (int r = 0; r < mask.rows; ++r) {
+        const uchar* row = mask.ptr<uchar>(r);
+        for (int c = 0; c < mask.cols;) {
+            if (row[c] == 0) {
+                ++c;
+                continue;
+            }
+            const int begin = c;
+            while (c < mask.cols && row[c] != 0) {
+                ++c;
+            }
+            result.m_lines[r].push_back({begin, c});
+        }
+    }
+    return result;
+}
+
+void SpanMask::unite(const SpanMask& other) {
+    if (other.empty()) {
+        return;
+    }
+    if (empty()) {
+        *this = other;
+        return;
+    }
+    if (other.m_size != m_size) {
+        throw std::invalid_argument("Cannot unite masks of different sizes.");
+    }
+    SpanMask aligned = other;
+    aligned.orient(m_byColumns);
+    for (size_t i = 0; i < m_lines.size(); ++i) {
+        m_lines[i].insert(m_lines[i].end(), aligned.m_lines[i].begin(), aligned.m_lines[i].end());
+        normalizeLine(m_lines[i]);
+    }
+}
+
+void SpanMask::orient(bool byColumns) {
+    if (m_byColumns == byColumns || empty()) {
+        return;
+    }
+    // Sweeping lines in order appends to the crossing lines in order, so the
+    // new runs come out sorted and only ever grow at their ends.
+    std::vector<std::vector<MaskSpan>> lines(byColumns ? m_size.width : m_size.height);
+    for (int i = 0; i < static_cast<int>(m_lines.size()); ++i) {
+        for (const MaskSpan& span : m_lines[i]) {
+            for (int j = span.begin; j < span.end; ++j) {
+                std::vector<MaskSpan>& line = lines[j];
+                if (!line.empty() && line.back().end == i) {
+                    ++line.back().end;
+                } else {
+                    line.push_back({i, i + 1});
+                }
+            }
+        }
+    }
+    m_lines.swap(lines);
+    m_byColumns = byColumns;
+}
+
+// ---
+// SpanMask: queries
+// ---
+
+void SpanMask::fill(cv::Mat& map, double value, int rowBegin, int rowEnd) const {
+    if (empty()) {
+        return;
+    }
+    if (!m_byColumns) {
+        for (int r = rowBegin; r < rowEnd; ++r) {
+            double* row = map.ptr<double>(r);
+            for (const MaskSpan& span : m_lines[r]) {
+                std::fill(row + span.begin, row + span.end, value);
+            }
+        }
+        return;
+    }
+    for (int c = 0; c < static_cast<int>(m_lines.size()); ++c) {
+        for (const MaskSpan& span : m_lines[c]) {
+            const int end = std::min(span.end, rowEnd);
+            for (int r = std::max(span.begin, rowBegin); r < end; ++r) {
+                map.ptr<double>(r)[c] = value;
+            }
+        }
+    }
+}
+
+cv::Rect SpanMask::bounds() const {
+    int firstLine = -1, lastLine = -1;
+    int alongBegin = std::numeric_limits<int>::max(), alongEnd = 0;
+    for (int i = 0; i < static_cast<int>(m_lines.size()); ++i) {
+        if (m_lines[i].empty()) {
+            continue;
+        }
+        if (firstLine < 0) firstLine = i;
+        lastLine = i;
+        alongBegin = std::min(alongBegin, m_lines[i].front().begin);
+        alongEnd = std::max(alongEnd, m_lines[i].back().end);
+    }
+    if (firstLine < 0) {
+        return cv::Rect();
+    }
+    return m_byColumns ? cv::Rect(firstLine, alongBegin, lastLine - firstLine + 1, alongEnd - alongBegin)
+                       : cv::Rect(alongBegin, firstLine, alongEnd - alongBegin, lastLine - firstLine + 1);
+}
+
+cv::Mat SpanMask::toMat() const {
+    if (empty()) {
+        return cv::Mat();
+    }
+    cv::Mat mask = cv::Mat::zeros(m_size, CV_8UC1);
+    for (int i = 0; i < static_cast<int>(m_lines.size()); ++i) {
+        for (const MaskSpan& span : m_lines[i]) {
+            if (m_byColumns) {
+                mask(cv::Rect(i, span.begin, 1, span.end - span.begin)).setTo(cv::Scalar(255));
+            } else {
+                mask(cv::Rect(span.begin, i, span.end - span.begin, 1)).setTo(cv::Scalar(255));
+            }
+        }
+    }
+    return mask;
+}
+
+size_t SpanMask::bytes() const {
+    size_t total = m_lines.capacity() * sizeof(std::vector<MaskSpan>);
+    for (const std::vector<MaskSpan>& line : m_lines) {
+        total += line.capacity() * sizeof(MaskSpan);
+    }
+    return total;
+}
+
+// ---
+// SpanMask: scaling
+// ---
+
+SpanMask SpanMask::resized(const cv::Size& size) const {
+    if (empty() || size == m_size) {
+        return *this;
+    }
+    SpanMask result;
+    result.m_size = size;
+    result.m_byColumns = m_byColumns;
+    const long long srcLines = m_lines.size();
+    const long long dstLines = m_byColumns ? size.width : size.height;
+    const long long srcAlong = m_byColumns ? m_size.height : m_size.width;
+    const long long dstAlong = m_byColumns ? size.height : size.width;
+    result.m_lines.resize(dstLines);
+    // Target pixel j samples source pixel floor(j * src / dst), so it is
+    // masked exactly when begin <= j * src / dst < end.
+    for (long long i = 0; i < dstLines; ++i) {
+        for (const MaskSpan& span : m_lines[i * srcLines / dstLines]) {
+            MaskSpan scaled{ceilDiv(span.begin * dstAlong, srcAlong), ceilDiv(span.end * dstAlong, srcAlong)};
+            if (scaled.end > scaled.begin) {
+                result.m_lines[i].push_back(scaled);
+            }
+        }
+    }
+    return result;
+}
+
+SpanMask SpanMask::reduced(const cv::Size& size) const {
+    if (empty() || size == m_size) {
+        return *this;
+    }
+    SpanMask result;
+    result.m_size = size;
+    result.m_byColumns = m_byColumns;
+    const long long srcLines = m_lines.size();
+    const long long dstLines = m_byColumns ? size.width : size.height;
+    const long long srcAlong = m_byColumns ? m_size.height : m_size.width;
+    const long long dstAlong = m_byColumns ? size.height : size.width;
+    result.m_lines.resize(dstLines);
+    for (long long i = 0; i < dstLines; ++i) {
+        std::vector<MaskSpan>& line = result.m_lines[i];
+        const long long last = std::min<long long>(srcLines, ceilDiv((i + 1) * srcLines, dstLines));
+        for (long long s = i * srcLines / dstLines; s < last; ++s) {
+            for (const MaskSpan& span : m_lines[s]) {
+                line.push_back({static_cast<int>(span.begin * dstAlong / srcAlong), ceilDiv(span.end * dstAlong, srcAlong)});
+            }
+        }
+        normalizeLine(line);
+    }
+    return result;
+}
+
+// ---
+// SpanMask: following seams
+// ---
+
+void SpanMask::removeVerticalSeam(const std::vector<int>& seam) {
+    if (empty()) {
+        return;
+    }
+    orient(false);
+    for (size_t r = 0; r < m_lines.size(); ++r) {
+        removeFromLine(m_lines[r], &seam[r], 1);
+    }
+    --m_size.width;
+}
+
+void SpanMask::removeHorizontalSeam(const std::vector<int>& seam) {
+    if (empty()) {
+        return;
+    }
+    orient(true);
+    for (size_t c = 0; c < m_lines.size(); ++c) {
+        removeFromLine(m_lines[c], &seam[c], 1);
+    }
+    --m_size.height;
+}
+
+void SpanMask::removeColumns(const cv::Mat& removed) {
+    if (empty()) {
+        return;
+    }
+    orient(false);
+    for (int r = 0; r < static_cast<int>(m_lines.size()); ++r) {
+        removeFromLine(m_lines[r], removed.ptr<int>(r), removed.cols);
+    }
+    m_size.width -= removed.cols;
+}
+
+void SpanMask::removeRows(const cv::Mat& removed) {
+    if (empty()) {
+        return;
+    }
+    orient(true);
+    for (int c = 0; c < static_cast<int>(m_lines.size()); ++c) {
+        removeFromLine(m_lines[c], removed.ptr<int>(c), removed.cols);
+    }
+    m_size.height -= removed.cols;
+}
+
+void SpanMask::insertVerticalSeams(const std::vector<std::vector<int>>& seams) {
+    if (empty() || seams.empty()) {
+        return;
+    }
+    orient(false);
+    std::vector<int> positions(seams.size());
+    for (size_t r = 0; r < m_lines.size(); ++r) {
+        for (size_t i = 0; i < seams.size(); ++i) {
+            positions[i] = seams[i][r];
+        }
+        std::sort(positions.begin(), positions.end());
+        insertIntoLine(m_lines[r], positions.data(), static_cast<int>(positions.size()));
+    }
+    m_size.width += static_cast<int>(seams.size());
+}
+
+void SpanMask::insertHorizontalSeams(const std::vector<std::vector<int>>& seams) {
+    if (empty() || seams.empty()) {
+        return;
+    }
+    orient(true);
+    std::vector<int> positions(seams.size());
+    for (size_t c = 0; c < m_lines.size(); ++c) {
+        for (size_t i = 0; i < seams.size(); ++i) {
+            positions[i] = seams[i][c];
+        }
+        std::sort(positions.begin(), positions.end());
+        insertIntoLine(m_lines[c], positions.data(), static_cast<int>(positions.size()));
+    }
+    m_size.height += static_cast<int>(seams.size());
+}
+
+// ---
+// Shape files
+// ---
+
+std::vector<MaskShape> readMaskShapes(std::istream& in) {
+    const std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const JsonValue root = JsonParser(text).parse();
+    const JsonValue* list = &root;
+    if (root.type == JsonValue::Type::Object) {
+        list = root.find("shapes");
+    }
+    if (list == nullptr || list->type != JsonValue::Type::Array) {
+        throw std::runtime_error("Invalid mask shapes: expected a \"shapes\" array.");
+    }
+    std::vector<MaskShape> shapes;
+    shapes.reserve(list->items.size());
+    for (const JsonValue& item : list->items) {
+        shapes.push_back(shapeFromJson(item));
+    }
+    return shapes;
+}
+
+void writeMaskShapes(std::ostream& out, const std::vector<MaskShape>& shapes) {
+    out << "{\"shapes\": [";
+    for (size_t i = 0; i < shapes.size(); ++i) {
+        const MaskShape& shape = shapes[i];
+        out << (i == 0 ? "\n" : ",\n") << "  {\"mode\": \"" << (shape.mode == MaskMode::Remove ? "remove" : "protect") << "\", ";
+        if (shape.polygon.empty()) {
+            out << "\"rect\": [" << shape.rect.x << ", " << shape.rect.y << ", " << shape.rect.width << ", "
+                << shape.rect.height << "]}";
+            continue;
+        }
+        out << "\"polygon\": [";
+        for (size_t k = 0; k < shape.polygon.size(); ++k) {
+            out << (k == 0 ? "" : ", ") << "[" << shape.polygon[k].x << ", " << shape.polygon[k].y << "]";
+        }
+        out << "]}";
+    }
+    out << "\n]}\n";
+}
+
+std::vector<MaskShape> loadMaskShapes(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Could not open mask shapes: " + path);
+    }
+    return readMaskShapes(in);
+}
+
+void saveMaskShapes(const std::string& path, const std::vector<MaskShape>& shapes) {
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("Could not write mask shapes: " + path);
+    }
+    writeMaskShapes(out, shapes);
+    if (!out) {
+        throw std::runtime_error("Could not write mask shapes: " + path);
+    }
+}
+
+std::vector<MaskShape> scaleMaskShapes(const std::vector<MaskShape>& shapes, double fx, double fy) {
+    std::vector<MaskShape> scaled = shapes;
+    for (MaskShape& shape : scaled) {
+        // Rectangles grow outward to whole pixels so nothing they covered is lost.
+        const int left = static_cast<int>(std::floor(shape.rect.x * fx));
+        const int top = static_cast<int>(std::floor(shape.rect.y * fy));
+        const int right = static_cast<int>(std::ceil((shape.rect.x + shape.rect.width) * fx));
+        const int bottom = static_cast<int>(std::ceil((shape.rect.y + shape.rect.height) * fy));
+        shape.rect = cv::Rect(left, top, right - left, bottom - top);
+        for (cv::Point2f& point : shape.polygon) {
+            point.x = static_cast<float>(point.x * fx);
+            point.y = static_cast<float>(point.y * fy);
+        }
+    }
+    return scaled;
+}
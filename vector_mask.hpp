@@ -0,0 +1,193 @@
+/**
+ * @file vector_mask.hpp
+ * @author Utkarsh Sachan
+ * @brief Protection and removal masks given as shapes, carried as per-line spans.
+ *
+ * A raster mask costs a byte per pixel and is compacted along with the image
+ * on every seam. A vector mask is a list of rectangles and polygons, each
+ * protecting or removing what it covers; the carver rasterizes it once into
+ * sorted runs per row (a SpanMask) and afterwards only moves run endpoints:
+ * a seam that passes left of a run shifts it, one that passes through it
+ * shortens it. Memory is a few bytes per run instead of per pixel.
+ *
+ * Shape files are JSON, in the pixel coordinates of the input image:
+ *
+ *   {"shapes": [
+ *     {"mode": "protect", "rect": [x, y, width, height]},
+ *     {"mode": "remove", "polygon": [[x, y], [x, y], [x, y], ...]}
+ *   ]}
+ *
+ * A bare array of shapes is accepted as well. Polygons are filled even-odd and
+ * cover the pixels whose centers lie inside.
+ */
+
+#pragma once
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief What a shape does to the pixels it covers.
+ */
+enum class MaskMode {
+    Protect, ///< Seams avoid these pixels.
+    Remove   ///< Seams are drawn through these pixels.
+};
+
+/**
+ * @brief One rectangle or polygon of a vector mask.
+ */
+struct MaskShape {
+    MaskMode mode = MaskMode::Protect;
+    cv::Rect rect;                    ///< The shape when `polygon` is empty.
+    std::vector<cv::Point2f> polygon; ///< Vertices in pixels (at least three), or empty.
+};
+
+/**
+ * @brief A half-open run [begin, end) of masked pixels along one line.
+ */
+struct MaskSpan {
+    int begin;
+    int end;
+};
+
+/**
+ * @class SpanMask
+ * @brief A binary mask stored as sorted, disjoint runs per row or per column.
+ *
+ * Runs follow the seams: vertical seams move runs within rows, horizontal
+ * seams within columns. The mask switches between row and column runs when
+ * the seam direction changes, which costs one pass over the masked pixels.
+ * A default-constructed mask is "absent" and ignores every update.
+ */
+class SpanMask {
+public:
+    SpanMask() = default;
+
+    /**
+     * @brief Rasterizes the shapes of one mode at the given image size.
+     * The result is present (not empty()) even if no shape touches the image.
+     */
+    static SpanMask fromShapes(const std::vector<MaskShape>& shapes, MaskMode mode, const cv::Size& size);
+
+    /**
+     * @brief Builds runs from the non-zero pixels of a CV_8U mask.
+     */
+    static SpanMask fromMat(const cv::Mat& mask);
+
+    /**
+     * @brief True if no mask is attached.
+     */
+    bool empty() const { return m_lines.empty(); }
+
+    /**
+     * @brief The image size the runs refer to.
+     */
+    cv::Size size() const { return m_size; }
+
+    /**
+     * @brief Adds the pixels of another mask of the same size.
+     */
+    void unite(const SpanMask& other);
+
+    /**
+     * @brief Sets the masked pixels of rows [rowBegin, rowEnd) of a CV_64F map to `value`.
+     */
+    void fill(cv::Mat& map, double value, int rowBegin, int rowEnd) const;
+
+    /**
+     * @brief Bounding box of the masked pixels (empty if none).
+     */
+    cv::Rect bounds() const;
+
+    /**
+     * @brief Rasterizes the mask into a CV_8U matrix (255 = masked).
+     */
+    cv::Mat toMat() const;
+
+    /**
+     * @brief The mask at another size, sampled like cv::INTER_NEAREST.
+     */
+    SpanMask resized(const cv::Size& size) const;
+
+    /**
+     * @brief The mask at a smaller size, where a pixel is masked if any pixel
+     * of the area it covers is (so thin regions survive the reduction).
+     */
+    SpanMask reduced(const cv::Size& size) const;
+
+    /**
+     * @brief Follows the removal of one vertical seam (one column per row).
+     */
+    void removeVerticalSeam(const std::vector<int>& seam);
+
+    /**
+     * @brief Follows the removal of one horizontal seam (one row per column).
+     */
+    void removeHorizontalSeam(const std::vector<int>& seam);
+
+    /**
+     * @brief Follows the removal of several columns per row.
+     * @param removed CV_32S, per row the sorted column indices dropped.
+     */
+    void removeColumns(const cv::Mat& removed);
+
+    /**
+     * @brief Follows the removal of several rows per column.
+     * @param removed CV_32S, per column the sorted row indices dropped.
+     */
+    void removeRows(const cv::Mat& removed);
+
+    /**
+     * @brief Follows the insertion of vertical seams (a pixel after each seam pixel).
+     * A pixel inserted inside a run belongs to it.
+     */
+    void insertVerticalSeams(const std::vector<std::vector<int>>& seams);
+
+    /**
+     * @brief Follows the insertion of horizontal seams (a pixel below each seam pixel).
+     */
+    void insertHorizontalSeams(const std::vector<std::vector<int>>& seams);
+
+    /**
+     * @brief Heap bytes held by the runs.
+     */
+    size_t bytes() const;
+
+private:
+    void orient(bool byColumns);
+
+    cv::Size m_size;
+    bool m_byColumns = false;
+    std::vector<std::vector<MaskSpan>> m_lines; ///< One entry per row (or column).
+};
+
+/**
+ * @brief Parses a shape list from a JSON stream (see the file comment).
+ * @throws std::runtime_error on malformed JSON or shapes.
+ */
+std::vector<MaskShape> readMaskShapes(std::istream& in);
+
+/**
+ * @brief Writes a shape list as JSON that readMaskShapes() accepts.
+ */
+void writeMaskShapes(std::ostream& out, const std::vector<MaskShape>& shapes);
+
+/**
+ * @brief Reads a shape list from a JSON file.
+ * @throws std::runtime_error if the file cannot be read or parsed.
+ */
+std::vector<MaskShape> loadMaskShapes(const std::string& path);
+
+/**
+ * @brief Writes a shape list to a JSON file.
+ * @throws std::runtime_error if the file cannot be written.
+ */
+void saveMaskShapes(const std::string& path, const std::vector<MaskShape>& shapes);
+
+/**
+ * @brief Scales shape coordinates by (fx, fy), e.g. from full to decoded resolution.
+ */
+std::vector<MaskShape> scaleMaskShapes(const std::vector<MaskShape>& shapes, double fx, double fy);
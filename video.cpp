@@ -0,0 +1,146 @@
+/**
+ * @file video.cpp
+ * @author Utkarsh Sachan
+ * @brief Implementation of video mode (see video.hpp).
+ */
+
+#include "video.hpp"
+
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "bounded_queue.hpp"
+#include "seam_carver.hpp"
+#include "thread_pool.hpp"
+
+namespace {
+
+/**
+ * @brief Remembers the first exception thrown by any pipeline stage.
+ */
+class PipelineError {
+public:
+    void capture() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_error) m_error = std::current_exception();
+    }
+
+    void rethrow() {
+        if (m_error) std::rethrow_exception(m_error);
+    }
+
+private:
+    std::mutex m_mutex;
+    std::exception_ptr m_error;
+};
+
+int parseFourcc(const std::string& code) {
+    if (code.size() != 4) {
+        throw std::invalid_argument("Codec must be a four-character code, e.g. mp4v: " + code);
+    }
+    return cv::VideoWriter::fourcc(code[0], code[1], code[2], code[3]);
+}
+
+} // namespace
+
+int runVideo(const std::string& inputPath, const std::string& outputPath, const VideoOptions& options) {
+    cv::VideoCapture capture(inputPath);
+    if (!capture.isOpened()) {
+        throw std::runtime_error("Could not open video: " + inputPath);
+    }
+    const double fps = capture.get(cv::CAP_PROP_FPS);
+    const int fourcc = options.fourcc.empty() ? static_cast<int>(capture.get(cv::CAP_PROP_FOURCC)) : parseFourcc(options.fourcc);
+    const int inputWidth = static_cast<int>(capture.get(cv::CAP_PROP_FRAME_WIDTH));
+    const int inputHeight = static_cast<int>(capture.get(cv::CAP_PROP_FRAME_HEIGHT));
+    const cv::Size outputSize(options.width == -1 ? inputWidth : options.width,
+                              options.height == -1 ? inputHeight : options.height);
+
+    cv::VideoWriter writer(outputPath, fourcc, fps > 0.0 ? fps : 30.0, outputSize);
+    if (!writer.isOpened()) {
+        throw std::runtime_error("Could not open video for writing: " + outputPath);
+    }
+
+    // The pool owns the carver's parallelism; OpenCV's own threads would oversubscribe.
+    cv::setNumThreads(1);
+    ThreadPool pool(options.jobs > 0 ? static_cast<unsigned>(options.jobs) : 0u);
+
+    std::cout << "Video: " << inputWidth << "x" << inputHeight << " -> " << outputSize.width << "x"
+              << outputSize.height << " on " << pool.size() << " thread(s)" << std::endl;
+    auto start = std::chrono::steady_clock::now();
+
+    BoundedQueue<cv::Mat> decoded(options.queueDepth);
+    BoundedQueue<cv::Mat> carved(options.queueDepth);
+    PipelineError error;
+
+    // --- Decode stage ---
+    std::thread decoder([&] {
+        try {
+            cv::Mat frame;
+            while (capture.read(frame)) {
+                // read() may reuse its buffer, so hand over a fresh one.
+                if (!decoded.push(frame)) break;
+                frame = cv::Mat();
+            }
+        } catch (...) {
+            error.capture();
+            carved.close();
+        }
+        decoded.close();
+    });
+
+    // --- Encode stage ---
+    int written = 0;
+    std::thread encoder([&] {
+        try {
+            cv::Mat frame;
+            while (carved.pop(frame)) {
+                writer.write(frame);
+                ++written;
+            }
+        } catch (...) {
+            error.capture();
+            decoded.close();
+        }
+        carved.close();
+    });
+
+    // --- Carve stage (this thread) ---
+    // Each frame depends on the previous frame's seams, so frames are carved
+    // in order; the pool parallelizes within a frame.
+    try {
+        std::vector<std::vector<int>> previousSeams;
+        cv::Mat frame;
+        for (int index = 0; decoded.pop(frame); ++index) {
+            SeamCarver carver(frame);
+            carver.setEnergyFunction(options.energy);
+            carver.setThreadPool(&pool, pool.size());
+            bool keyframe = previousSeams.empty() ||
+                            (options.keyframeInterval > 0 && index % options.keyframeInterval == 0);
+            if (!keyframe) {
+                carver.setSeamGuide(std::move(previousSeams), options.corridor);
+            }
+            carver.resize(outputSize.width, outputSize.height);
+            previousSeams = carver.searchedSeams();
+            if (!carved.push(carver.image())) break;
+        }
+    } catch (...) {
+        error.capture();
+        decoded.close();
+    }
+    carved.close();
+
+    decoder.join();
+    encoder.join();
+    error.rethrow();
+
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Video complete: " << written << " frame(s) in " << elapsed << " s ("
+              << (elapsed > 0.0 ? written / elapsed : 0.0) << " fps)" << std::endl;
+    return written;
+}
@@ -0,0 +1,42 @@
+/**
+ * @file video.hpp
+ * @author Utkarsh Sachan
+ * @brief Video mode: retarget every frame of a clip with temporally coherent seams.
+ *
+ * Carving each frame independently makes seams jump between frames, which
+ * shows as flicker. Here every frame's seam searches are warm-started from
+ * the previous frame's seams and restricted to a narrow corridor around them
+ * (see SeamCarver::setSeamGuide()), so seams follow the content smoothly and
+ * each search only touches the corridor. A keyframe periodically runs the
+ * full search so seams can re-settle after scene changes.
+ *
+ * Decoding, carving and encoding run on separate threads connected by
+ * bounded queues; the carver splits its own loops across a thread pool.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "energy.hpp"
+
+/**
+ * @brief Settings for runVideo().
+ */
+struct VideoOptions {
+    int width = -1;  ///< Target frame width (-1 = original).
+    int height = -1; ///< Target frame height (-1 = original).
+    EnergyFunction energy = EnergyFunction::Sobel5;
+    int jobs = 0;              ///< Carver threads (0 = hardware concurrency).
+    int corridor = 8;          ///< Pixels a seam may move between consecutive frames.
+    int keyframeInterval = 30; ///< Run a full search every N frames (0 = first frame only).
+    int queueDepth = 4;        ///< Frames buffered between pipeline stages.
+    std::string fourcc;        ///< Output codec, e.g. "mp4v" (empty = the input's codec).
+};
+
+/**
+ * @brief Retargets a video file frame by frame.
+ * @return The number of frames written.
+ * @throws std::runtime_error if the input cannot be read or the output cannot be written.
+ */
+int runVideo(const std::string& inputPath, const std::string& outputPath, const VideoOptions& options);